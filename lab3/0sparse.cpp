@@ -4,6 +4,9 @@
 #include <cmath>
 #include <fstream>
 #include <sstream>
+#include <unordered_map>
+#include <cstdint>
+#include <cassert>
 
 using namespace std;
 
@@ -73,122 +76,191 @@ int count_none_zeros(const vector<vector<vector<vector<double>>>>& sparseMatrix4
     return num_of_none_zeros;
 }
 
-// input data non-zero item coordination index storage
-vector<vector<double>> generate_none_zero_list(const vector<vector<vector<vector<double>>>>& sparseMatrix4D, size_t none_zero_nums) {
-    vector<vector<double>> none_zeros_list(none_zero_nums, vector<double>(2)); // index: none_zero_item_index, value: [input_h, input_w]
-    size_t curr_index = 0;
-    for (size_t i = 0; i < HEIGHT_FEATURE; i++) {
-        for (size_t j = 0; j < WIDTH_FEATURE; j++) {
-            if (cloudData[0][0][i][j] != 0) {
-                size_t index = curr_index++;
-                none_zeros_list[index][0] = i;
-                none_zeros_list[index][1] = j;
+// input data non-zero item coordination index storage, structure of arrays: site i is (h[i], w[i]) with value[i]
+struct NoneZeroList {
+    vector<int32_t> h, w;
+    vector<double> value; // [n x IN_CHANNELS]
+    size_t size() const { return h.size(); }
+};
+
+NoneZeroList generate_none_zero_list(const vector<vector<vector<vector<double>>>>& sparseMatrix4D, size_t none_zero_nums) {
+    NoneZeroList none_zeros_list;
+    none_zeros_list.h.reserve(none_zero_nums);
+    none_zeros_list.w.reserve(none_zero_nums);
+    none_zeros_list.value.reserve(none_zero_nums * IN_CHANNELS);
+    for (int i = 0; i < HEIGHT_FEATURE; i++) {
+        for (int j = 0; j < WIDTH_FEATURE; j++) {
+            if (sparseMatrix4D[0][0][i][j] != 0) {
+                none_zeros_list.h.push_back(i);
+                none_zeros_list.w.push_back(j);
+                for (int ic = 0; ic < IN_CHANNELS; ++ic) none_zeros_list.value.push_back(sparseMatrix4D[0][ic][i][j]);
             }
         }
     }
     return none_zeros_list;
 }
 
-// kernel data coordination index storage
-vector<vector<int>> generate_kernel_coordinates() {
-    vector<vector<int>> kernel_coords;
+// kernel data, transposed to [kh * K + kw][IN_CHANNELS][OUT_CHANNELS] so one rule reads its OC weights contiguously
+vector<double> generate_kernel_matrix() {
+    vector<double> kernel_matrix(KERNEL_SIZE * KERNEL_SIZE * IN_CHANNELS * OUT_CHANNELS);
+    for (int out_channel = 0; out_channel < OUT_CHANNELS; ++out_channel)
+        for (int in_channel = 0; in_channel < IN_CHANNELS; ++in_channel)
+            for (int kh = 0; kh < KERNEL_SIZE; ++kh)
+                for (int kw = 0; kw < KERNEL_SIZE; ++kw)
+                    kernel_matrix[((kh * KERNEL_SIZE + kw) * IN_CHANNELS + in_channel) * OUT_CHANNELS + out_channel] = kernel[out_channel][in_channel][kh][kw];
+    return kernel_matrix;
+}
 
-    for (size_t out_channel = 0; out_channel < OUT_CHANNELS; ++out_channel) {
-        for (size_t in_channel = 0; in_channel < IN_CHANNELS; ++in_channel) {
-            for (size_t kh = 0; kh < KERNEL_SIZE; ++kh) {
-                for (size_t kw = 0; kw < KERNEL_SIZE; ++kw) {
-                    kernel_coords.push_back({ static_cast<int>(out_channel), static_cast<int>(in_channel), static_cast<int>(kh), static_cast<int>(kw) });
-                }
+// rulebook, the SoA32 layout of 20rulebook.cpp: rules grouped by kernel offset, one (input, output) uint32 pair
+// per (nonzero input, offset) that lands inside the output, shared by all output channels.
+// in_idx is the none_zeros_list index, out_idx the output coordinate oh * OUTPUT_WIDTH + ow.
+struct Rulebook {
+    vector<uint32_t> offset_ptr; // offset k owns rules [offset_ptr[k], offset_ptr[k + 1])
+    vector<uint32_t> in_idx, out_idx;
+    size_t size() const { return in_idx.size(); }
+    size_t bytes() const { return (offset_ptr.size() + in_idx.size() + out_idx.size()) * sizeof(uint32_t); }
+};
+
+// rulebook construction: count the rules of every offset, then fill them in place
+Rulebook generate_rulebook(const NoneZeroList& none_zeros_list) {
+    Rulebook rulebook;
+    rulebook.offset_ptr.assign(KERNEL_SIZE * KERNEL_SIZE + 1, 0);
+    auto output_coordinate = [&](size_t i, int kh, int kw) {
+        // calculate output coordinates, -1 when they fall outside the output
+        int output_h = none_zeros_list.h[i] - kh + PADDING;
+        int output_w = none_zeros_list.w[i] - kw + PADDING;
+        if (output_h < 0 || output_h >= OUTPUT_HEIGHT || output_w < 0 || output_w >= OUTPUT_WIDTH) return -1;
+        return output_h * OUTPUT_WIDTH + output_w;
+    };
+    for (size_t i = 0; i < none_zeros_list.size(); i++)
+        for (int kh = 0; kh < KERNEL_SIZE; kh++)
+            for (int kw = 0; kw < KERNEL_SIZE; kw++)
+                if (output_coordinate(i, kh, kw) >= 0) rulebook.offset_ptr[kh * KERNEL_SIZE + kw + 1]++;
+    for (int k = 0; k < KERNEL_SIZE * KERNEL_SIZE; ++k) rulebook.offset_ptr[k + 1] += rulebook.offset_ptr[k];
+
+    rulebook.in_idx.resize(rulebook.offset_ptr.back());
+    rulebook.out_idx.resize(rulebook.offset_ptr.back());
+    vector<uint32_t> next(rulebook.offset_ptr.begin(), rulebook.offset_ptr.end() - 1);
+    for (size_t i = 0; i < none_zeros_list.size(); i++)
+        for (int kh = 0; kh < KERNEL_SIZE; kh++)
+            for (int kw = 0; kw < KERNEL_SIZE; kw++) {
+                int output_idx = output_coordinate(i, kh, kw);
+                if (output_idx < 0) continue;
+                uint32_t r = next[kh * KERNEL_SIZE + kw]++;
+                rulebook.in_idx[r] = i;
+                rulebook.out_idx[r] = output_idx;
             }
+    return rulebook;
+}
+
+// do multiplication, offset by offset, every rule scatters into all output channels
+vector<vector<vector<vector<double>>>> do_sparse_conv(const Rulebook& rulebook, const NoneZeroList& none_zeros_list, const vector<double>& kernel_matrix) {
+    vector<vector<vector<vector<double>>>> output(BATCH, vector<vector<vector<double>>>(OUT_CHANNELS, vector<vector<double>>(OUTPUT_HEIGHT, vector<double>(OUTPUT_WIDTH, 0.0))));
+    for (int k = 0; k < KERNEL_SIZE * KERNEL_SIZE; ++k) {
+        const double* kernel_data = &kernel_matrix[size_t(k) * IN_CHANNELS * OUT_CHANNELS];
+        for (uint32_t r = rulebook.offset_ptr[k]; r < rulebook.offset_ptr[k + 1]; ++r) {
+            const double* input_data = &none_zeros_list.value[size_t(rulebook.in_idx[r]) * IN_CHANNELS];
+            int oh = rulebook.out_idx[r] / OUTPUT_WIDTH, ow = rulebook.out_idx[r] % OUTPUT_WIDTH;
+            for (int in_channel = 0; in_channel < IN_CHANNELS; ++in_channel)
+                for (int out_channel = 0; out_channel < OUT_CHANNELS; ++out_channel)
+                    output[0][out_channel][oh][ow] += input_data[in_channel] * kernel_data[in_channel * OUT_CHANNELS + out_channel];
         }
     }
-
-    return kernel_coords;
+    return output;
 }
 
-// output data coordination index storage
-vector<vector<int>> generate_output_coordinates(const vector<vector<double>>& none_zeros_list, int none_zero_nums) {
-    vector<vector<int>> output_coords;
+vector<vector<vector<vector<double>>>> sparse_conv(vector<vector<vector<vector<double>>>>& cloudData) {
+    int num_of_none_zeros = count_none_zeros(cloudData);
+    NoneZeroList none_zeros_list = generate_none_zero_list(cloudData, num_of_none_zeros); // site i: (h[i], w[i]), value[i]
+    vector<double> kernel_matrix = generate_kernel_matrix(); // [K*K][IC][OC]
+    Rulebook rulebook = generate_rulebook(none_zeros_list); // per offset: in_idx -> out_idx
+    vector<vector<vector<vector<double>>>> output = do_sparse_conv(rulebook, none_zeros_list, kernel_matrix);
+    return output;
+}
 
-    for (int i = 0; i < none_zero_nums; i++) {
-        int input_h = none_zeros_list[i][0];
-        int input_w = none_zeros_list[i][1];
+// Sparse tensor: active sites only, coords[i] = {batch, h, w} owns features[i * channels .. (i + 1) * channels)
+struct SparseTensor {
+    int height = 0, width = 0, channels = 0;
+    vector<vector<int>> coords;
+    vector<double> features; // [n x channels], dense per site
+    size_t size() const { return coords.size(); }
+};
+
+// CONVERT the dense cloud into a sparse tensor of its nonzero sites
+SparseTensor to_sparse(const vector<vector<vector<vector<double>>>>& dense) {
+    SparseTensor t;
+    t.height = dense[0][0].size();
+    t.width = dense[0][0][0].size();
+    t.channels = dense[0].size();
+    for (size_t b = 0; b < dense.size(); ++b) {
+        for (int h = 0; h < t.height; ++h) {
+            for (int w = 0; w < t.width; ++w) {
+                bool active = false;
+                for (int c = 0; c < t.channels; ++c) active = active || dense[b][c][h][w] != 0;
+                if (!active) continue;
+                t.coords.push_back({ static_cast<int>(b), h, w });
+                for (int c = 0; c < t.channels; ++c) t.features.push_back(dense[b][c][h][w]);
+            }
+        }
+    }
+    return t;
+}
 
+// sparse conv from sparse tensor to sparse tensor, the output sites are the dilated input sites
+SparseTensor sparse_conv_to_sparse(const SparseTensor& in, const vector<vector<vector<vector<double>>>>& kernel) {
+    SparseTensor out;
+    out.height = (in.height - KERNEL_SIZE + 2 * PADDING) / STRIDE + 1;
+    out.width = (in.width - KERNEL_SIZE + 2 * PADDING) / STRIDE + 1;
+    out.channels = kernel.size();
+    int in_channels = in.channels;
+
+    // output coordinate hash: packed (batch, h, w) -> output site index, rules per offset in the SoA32 layout of Rulebook
+    unordered_map<long long, int> out_index;
+    out_index.reserve(in.size() * KERNEL_SIZE * KERNEL_SIZE);
+    vector<vector<uint32_t>> in_idx(KERNEL_SIZE * KERNEL_SIZE), out_idx(KERNEL_SIZE * KERNEL_SIZE);
+    for (size_t i = 0; i < in.size(); ++i) {
         for (int kh = 0; kh < KERNEL_SIZE; kh++) {
             for (int kw = 0; kw < KERNEL_SIZE; kw++) {
-                // calculate output coordinates
-                int output_h = input_h - kh + PADDING;
-                int output_w = input_w - kw + PADDING;
-                // check output coordinates are valid
-                if (output_h >= 0 && output_h < OUTPUT_HEIGHT &&
-                    output_w >= 0 && output_w < OUTPUT_WIDTH) {
-                    for (size_t batch = 0; batch < BATCH; ++batch) {
-                        for (size_t out_channel = 0; out_channel < OUT_CHANNELS; ++out_channel) {
-                            output_coords.push_back({ static_cast<int>(batch), static_cast<int>(out_channel), static_cast<int>(output_h), static_cast<int>(output_w) });
-                        }
-                    }
-                }
+                int output_h = in.coords[i][1] - kh + PADDING;
+                int output_w = in.coords[i][2] - kw + PADDING;
+                if (output_h < 0 || output_h >= out.height || output_w < 0 || output_w >= out.width) continue;
+                long long key = (static_cast<long long>(in.coords[i][0]) * out.height + output_h) * out.width + output_w;
+                auto inserted = out_index.emplace(key, static_cast<int>(out.coords.size()));
+                if (inserted.second) out.coords.push_back({ in.coords[i][0], output_h, output_w });
+                in_idx[kh * KERNEL_SIZE + kw].push_back(i);
+                out_idx[kh * KERNEL_SIZE + kw].push_back(inserted.first->second);
             }
         }
     }
 
-    return output_coords;
-}
-
-// rulebook construction
-vector<vector<double>> generate_rulebook(const vector<vector<double>>& none_zeros_list, vector<vector<int>>& output_coordinate_list, size_t none_zero_nums) {
-    vector<vector<double>> rulebook(output_coordinate_list.size(), vector<double>(3)); // [none_zero_input_coordinates_index, output_coordinates_index, kernel_coordinates_index]
-
-    for (size_t i = 0; i < output_coordinate_list.size(); ++i) {
-        size_t none_zero_input_idx = i / (KERNEL_SIZE * KERNEL_SIZE * OUT_CHANNELS);
-        size_t output_idx = i; 
-        size_t kernel_idx = i % (KERNEL_SIZE * KERNEL_SIZE * OUT_CHANNELS);
-
-        rulebook[i][0] = none_zero_input_idx;
-        rulebook[i][1] = output_idx;
-        rulebook[i][2] = kernel_idx;
+    // only the [n_out x OC] block is zero-filled, never the dense grid
+    out.features.assign(out.size() * out.channels, 0.0);
+    for (int kh = 0; kh < KERNEL_SIZE; kh++) {
+        for (int kw = 0; kw < KERNEL_SIZE; kw++) {
+            int k = kh * KERNEL_SIZE + kw;
+            for (size_t r = 0; r < in_idx[k].size(); ++r) {
+                const double* in_feature = &in.features[static_cast<size_t>(in_idx[k][r]) * in_channels];
+                double* out_feature = &out.features[static_cast<size_t>(out_idx[k][r]) * out.channels];
+                for (int oc = 0; oc < out.channels; ++oc) {
+                    for (int ic = 0; ic < in_channels; ++ic) {
+                        out_feature[oc] += in_feature[ic] * kernel[oc][ic][kh][kw];
+                    }
+                }
+            }
+        }
     }
-
-    return rulebook;
+    return out;
 }
 
-// do multiplication
-vector<vector<vector<vector<double>>>> do_sparse_conv(vector<vector<double>>& rulebook, vector<vector<double>>& none_zeros_list, vector<vector<int>>& output_coordinate_list, vector<vector<int>>& kernel_coordinate_list) {
-    vector<vector<vector<vector<double>>>> output(BATCH, vector<vector<vector<double>>>(OUT_CHANNELS, vector<vector<double>>(OUTPUT_HEIGHT, vector<double>(OUTPUT_WIDTH, 0.0))));
-    for (size_t i = 0; i < rulebook.size(); i++){
-        size_t input_index = rulebook[i][0];
-        size_t output_index = rulebook[i][1];
-        size_t kernel_index = rulebook[i][2];
-
-        size_t in_batch = 1;
-        size_t in_channels = 1;
-        size_t input_h = none_zeros_list[input_index][0];
-        size_t input_w = none_zeros_list[input_index][1];
-        double input_data = cloudData[in_batch - 1][in_channels - 1][input_h][input_w];
-
-        size_t koutc = kernel_coordinate_list[kernel_index][0];
-        size_t kinc = kernel_coordinate_list[kernel_index][1];
-        size_t kh = kernel_coordinate_list[kernel_index][2];
-        size_t kw = kernel_coordinate_list[kernel_index][3];
-        double kernel_data = kernel[koutc][kinc][kh][kw];
-
-        size_t out_batch = output_coordinate_list[output_index][0];
-        size_t out_channels = output_coordinate_list[output_index][1];
-        size_t oh = output_coordinate_list[output_index][2];
-        size_t ow = output_coordinate_list[output_index][3];
-        output[out_batch][out_channels][oh][ow] += input_data * kernel_data;
+// DENSIFY only when a dense grid is requested
+vector<vector<vector<vector<double>>>> densify(const SparseTensor& t, int batch) {
+    vector<vector<vector<vector<double>>>> dense(batch, vector<vector<vector<double>>>(t.channels, vector<vector<double>>(t.height, vector<double>(t.width, 0.0))));
+    for (size_t i = 0; i < t.size(); ++i) {
+        for (int c = 0; c < t.channels; ++c) {
+            dense[t.coords[i][0]][c][t.coords[i][1]][t.coords[i][2]] = t.features[i * t.channels + c];
+        }
     }
-    return output;
-}
-
-vector<vector<vector<vector<double>>>> sparse_conv(vector<vector<vector<vector<double>>>>& cloudData) {
-    int num_of_none_zeros = count_none_zeros(cloudData);
-    vector<vector<double>> none_zeros_list = generate_none_zero_list(cloudData, num_of_none_zeros); // index: none_zero_item_index, value: [input_h, input_w]
-    vector<vector<int>> output_coordinate_list = generate_output_coordinates(none_zeros_list, num_of_none_zeros); // none_zero output item map
-    vector<vector<int>> kernel_coordinate_list = generate_kernel_coordinates(); // kernel index map
-    vector<vector<double>> rulebook = generate_rulebook(none_zeros_list, output_coordinate_list, num_of_none_zeros); // [none_zero_input_index, output_index, kernel_index]
-    vector<vector<vector<vector<double>>>> output = do_sparse_conv(rulebook, none_zeros_list, output_coordinate_list, kernel_coordinate_list);
-    return output;
+    return dense;
 }
 
 int main() {
@@ -205,6 +277,28 @@ int main() {
         avg_time += get_time() - t;
     }
     cout << "###@@@ Avg Time for Calculation(sparse_conv, out_channel = " << OUT_CHANNELS << "): " << avg_time / iterations << "s." << endl;
+    Rulebook rulebook = generate_rulebook(generate_none_zero_list(cloudData, count_none_zeros(cloudData)));
+    cout << "Rulebook: " << rulebook.size() << " rules, " << rulebook.bytes() / 1024.0 << " KB (" << double(rulebook.bytes()) / rulebook.size() << " B per rule)" << endl;
+    cout << endl;
+
+    // CHECK the sparse output matches the dense one once densified
+    SparseTensor sparse_input = to_sparse(cloudData);
+    SparseTensor sparse_output = sparse_conv_to_sparse(sparse_input, kernel);
+    assert(densify(sparse_output, BATCH) == sparse_conv(cloudData));
+
+    cout << "===== SPARSE CONV (SPARSE OUTPUT) OUT_CHANNELS = " << OUT_CHANNELS << " =====" << endl;
+    double sparse_time = 0.0, densify_time = 0.0;
+    for (int iter = 0; iter < iterations; iter++) {
+        auto t = get_time();
+        SparseTensor output = sparse_conv_to_sparse(sparse_input, kernel);
+        sparse_time += get_time() - t;
+        cout << "Rnd:" << iter + 1 << "\tTime:" << get_time() - t << "s\tActive sites: " << output.size() << "\tFeatures: [" << output.size() << ", " << output.channels << "]" << endl;
+        t = get_time();
+        densify(output, BATCH);
+        densify_time += get_time() - t;
+    }
+    cout << "###@@@ Avg Time for Calculation(sparse_conv to sparse, out_channel = " << OUT_CHANNELS << "): " << sparse_time / iterations
+         << "s, densify on request: +" << densify_time / iterations << "s, speedup over dense output: " << avg_time / sparse_time << "x." << endl;
     cout << endl;
 
     return 0;
@@ -0,0 +1,309 @@
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <unistd.h>
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <new>
+#include <unordered_map>
+#include <cassert>
+
+using namespace std;
+
+/*
+ Huge-page backed, 64-byte aligned allocator for the large conv buffers. Blocks of
+ at least HUGE_THRESHOLD bytes are mmap'ed on a 2 MB boundary and either taken from
+ the explicit hugetlb pool (MAP_HUGETLB) or marked MADV_HUGEPAGE for transparent
+ huge pages; small blocks use aligned_alloc. With prefault on, the pages are
+ populated at allocation time so the first touch in the conv does not fault. Every
+ mmap'ed block is recorded with its mapped size, so huge_free releases a block the
+ way it was allocated whatever the policy is by then.
+
+ The im2col conv below runs with std::allocator and with the huge-page allocator on
+ buffers allocated once outside the timed loop, and reports the page faults of the
+ first (cold) iteration, the later iterations and dTLB load misses.
+*/
+
+// INITIALIZE paras
+size_t BATCH = 1; // firmed at 1
+size_t HEIGHT = 64;
+size_t WIDTH = 4096;
+size_t IN_CHANNELS = 1;
+size_t OUT_CHANNELS = 256;
+size_t KERNEL_SIZE = 3;
+size_t STRIDE = 1;
+size_t PADDING = 0;
+int iterations = 8;
+
+const size_t CACHE_LINE = 64;
+const size_t HUGE_PAGE = 2 << 20;
+const size_t HUGE_THRESHOLD = 1 << 20;
+
+double get_time() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+// Process-wide policy of the allocator, set once before the buffers are created
+struct HugePagePolicy {
+    bool enabled = true;   // false falls back to plain 64-byte aligned_alloc
+    bool explicit_pages = false; // try the hugetlb pool first, THP when it is empty
+    bool prefault = false; // populate the pages inside allocate()
+};
+HugePagePolicy huge_policy;
+
+// mmap'ed blocks -> mapped bytes, anything else came from aligned_alloc
+unordered_map<void*, size_t> huge_blocks;
+
+// What the kernel actually granted, madvise can fail on kernels without THP or POPULATE_WRITE
+struct HugeStats {
+    int hugetlb_blocks = 0, thp_blocks = 0, advise_failures = 0, populate_fallbacks = 0;
+};
+HugeStats huge_stats;
+
+inline size_t round_up(size_t n, size_t align) { return (n + align - 1) / align * align; }
+
+void* huge_alloc(size_t bytes) {
+    if (!huge_policy.enabled || bytes < HUGE_THRESHOLD) {
+        void* p = aligned_alloc(CACHE_LINE, round_up(max(bytes, size_t(1)), CACHE_LINE));
+        if (!p) throw bad_alloc();
+        return p;
+    }
+    size_t size = round_up(bytes, HUGE_PAGE);
+    int populate = huge_policy.prefault ? MAP_POPULATE : 0;
+    if (huge_policy.explicit_pages) {
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | populate, -1, 0);
+        if (p != MAP_FAILED) {
+            huge_blocks[p] = size;
+            ++huge_stats.hugetlb_blocks;
+            return p;
+        }
+    }
+    // OVER-MAP by one huge page and trim, so the block starts on a 2 MB boundary THP can back
+    char* raw = static_cast<char*>(mmap(nullptr, size + HUGE_PAGE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (raw == MAP_FAILED) throw bad_alloc();
+    char* p = reinterpret_cast<char*>(round_up(reinterpret_cast<uintptr_t>(raw), HUGE_PAGE));
+    if (p > raw) munmap(raw, p - raw);
+    if (raw + HUGE_PAGE > p) munmap(p + size, raw + HUGE_PAGE - p);
+    huge_blocks[p] = size;
+    ++huge_stats.thp_blocks;
+    if (madvise(p, size, MADV_HUGEPAGE) != 0) ++huge_stats.advise_failures;
+    if (huge_policy.prefault && madvise(p, size, MADV_POPULATE_WRITE) != 0) {
+        // OLDER kernels lack MADV_POPULATE_WRITE, touch one byte per 4 KB page instead
+        ++huge_stats.populate_fallbacks;
+        for (size_t off = 0; off < size; off += 4096) p[off] = 0;
+    }
+    return p;
+}
+
+void huge_free(void* p, size_t) {
+    auto it = huge_blocks.find(p);
+    if (it == huge_blocks.end()) {
+        free(p);
+        return;
+    }
+    munmap(p, it->second);
+    huge_blocks.erase(it);
+}
+
+template <typename T>
+struct HugePageAllocator {
+    typedef T value_type;
+    HugePageAllocator() = default;
+    template <typename U> HugePageAllocator(const HugePageAllocator<U>&) {}
+    T* allocate(size_t n) { return static_cast<T*>(huge_alloc(n * sizeof(T))); }
+    void deallocate(T* p, size_t n) { huge_free(p, n * sizeof(T)); }
+};
+template <typename T, typename U> bool operator==(const HugePageAllocator<T>&, const HugePageAllocator<U>&) { return true; }
+template <typename T, typename U> bool operator!=(const HugePageAllocator<T>&, const HugePageAllocator<U>&) { return false; }
+
+// dTLB load misses of this thread through perf_event_open, -1 when the counter is unavailable
+struct TlbCounter {
+    int fd = -1;
+    TlbCounter() {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+    ~TlbCounter() { if (fd >= 0) close(fd); }
+    long long read_count() const {
+        long long value = 0;
+        if (fd < 0 || read(fd, &value, sizeof(value)) != sizeof(value)) return -1;
+        return value;
+    }
+};
+
+long minor_faults() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_minflt;
+}
+
+vector<double> cloud(HEIGHT * WIDTH);
+
+void init(const string& filename, size_t rows, size_t cols) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Failed to open file: " << filename << endl;
+        return;
+    }
+
+    string line;
+    size_t row = 0;
+
+    while (getline(file, line)) { // split the data by line
+        if (row >= rows) break;
+        stringstream ss(line);
+        string value;
+        size_t col = 0;
+
+        while (getline(ss, value, ',')) { // split each line by ","
+            if (col >= cols) break;
+            cloud[row * cols + col] = round(stod(value));
+            col++;
+        }
+        row++;
+    }
+
+    file.close();
+}
+
+// Uninitialized buffer from Alloc, so its pages are first touched by the conv unless prefaulted
+template <typename Alloc>
+struct Buffer {
+    Alloc alloc;
+    size_t n;
+    double* data;
+    explicit Buffer(size_t n) : n(n), data(alloc.allocate(n)) {}
+    ~Buffer() { alloc.deallocate(data, n); }
+    Buffer(const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
+    double& operator[](size_t i) { return data[i]; }
+    const double& operator[](size_t i) const { return data[i]; }
+};
+
+// Every large buffer of one conv, allocated once before the timed iterations
+template <typename Alloc>
+struct Workspace {
+    size_t pixels, col_width;
+    Buffer<Alloc> im2col_matrix, result, output;
+    Workspace(size_t pixels, size_t col_width)
+        : pixels(pixels), col_width(col_width), im2col_matrix(pixels * col_width), result(pixels * OUT_CHANNELS), output(pixels * OUT_CHANNELS) {}
+};
+
+// EXECUTE Conv2D using im2col on flat buffers, the output lands in ws.output [OC][OH][OW]
+template <typename Alloc>
+void conv2d_im2col(const vector<double, Alloc>& input, const vector<double, Alloc>& kernel_matrix, Workspace<Alloc>& ws) {
+    int height = HEIGHT, width = WIDTH, K = KERNEL_SIZE, S = STRIDE, P = PADDING;
+    int out_channels = OUT_CHANNELS;
+    int out_height = (height - K + 2 * P) / S + 1;
+    int out_width = (width - K + 2 * P) / S + 1;
+    int col_width = ws.col_width;
+    size_t pixels = ws.pixels;
+
+    // CALCULATE im2col matrix
+    Buffer<Alloc>& im2col_matrix = ws.im2col_matrix;
+    for (int h = 0; h < out_height; ++h) {
+        for (int w = 0; w < out_width; ++w) {
+            double* col = &im2col_matrix[(size_t(h) * out_width + w) * col_width];
+            for (int kh = 0; kh < K; ++kh) {
+                for (int kw = 0; kw < K; ++kw) {
+                    int h_offset = h * S + kh - P;
+                    int w_offset = w * S + kw - P;
+                    col[kh * K + kw] = (h_offset >= 0 && h_offset < height && w_offset >= 0 && w_offset < width) ? input[size_t(h_offset) * width + w_offset] : 0.0;
+                }
+            }
+        }
+    }
+
+    // MULTIPLY into the [pixels x OC] result matrix
+    Buffer<Alloc>& result = ws.result;
+    for (size_t p = 0; p < pixels; ++p) {
+        const double* col = &im2col_matrix[p * col_width];
+        double* res = &result[p * out_channels];
+        for (int oc = 0; oc < out_channels; ++oc) {
+            const double* k = &kernel_matrix[size_t(oc) * col_width];
+            double sum = 0.0;
+            for (int i = 0; i < col_width; ++i) sum += col[i] * k[i];
+            res[oc] = sum;
+        }
+    }
+
+    // RESHAPE result to [OC][OH][OW]
+    for (int oc = 0; oc < out_channels; ++oc)
+        for (size_t p = 0; p < pixels; ++p)
+            ws.output[size_t(oc) * pixels + p] = result[p * out_channels + oc];
+}
+
+template <typename Alloc>
+double run(const string& name, double* checksum) {
+    vector<double, Alloc> input(cloud.begin(), cloud.end());
+    vector<double, Alloc> kernel_matrix(OUT_CHANNELS * IN_CHANNELS * KERNEL_SIZE * KERNEL_SIZE, 0.5);
+
+    int out_height = (HEIGHT - KERNEL_SIZE + 2 * PADDING) / STRIDE + 1, out_width = (WIDTH - KERNEL_SIZE + 2 * PADDING) / STRIDE + 1;
+    huge_stats = HugeStats();
+    Workspace<Alloc> ws(size_t(out_height) * out_width, IN_CHANNELS * KERNEL_SIZE * KERNEL_SIZE);
+
+    TlbCounter tlb;
+    double avg_time = 0.0;
+    long cold_faults = 0, warm_faults = 0;
+    long long tlb_misses = 0;
+    for (int iter = 0; iter < iterations; iter++) {
+        long f0 = minor_faults();
+        long long t0 = tlb.read_count();
+        auto t = get_time();
+        conv2d_im2col(input, kernel_matrix, ws);
+        avg_time += get_time() - t;
+        (iter == 0 ? cold_faults : warm_faults) += minor_faults() - f0;
+        tlb_misses += tlb.read_count() - t0;
+        if (iter == 0) {
+            *checksum = 0.0;
+            for (size_t i = 0; i < ws.output.n; ++i) *checksum += ws.output[i];
+        }
+    }
+    cout << name << "\tTime: " << avg_time / iterations << "s\tPage faults 1st iter: " << cold_faults << ", later/iter: " << warm_faults / max(1, iterations - 1)
+         << "\tblocks hugetlb/THP: " << huge_stats.hugetlb_blocks << "/" << huge_stats.thp_blocks;
+    if (huge_stats.advise_failures || huge_stats.populate_fallbacks)
+        cout << " (madvise HUGEPAGE failed " << huge_stats.advise_failures << "x, POPULATE_WRITE fell back " << huge_stats.populate_fallbacks << "x)";
+    cout << "\tdTLB load misses/iter: ";
+    if (tlb.fd >= 0) cout << tlb_misses / iterations << endl;
+    else cout << "n/a (perf_event_open unavailable)" << endl;
+    return avg_time / iterations;
+}
+
+int main() {
+    string filename = "pointcloud.csv";
+    init(filename, HEIGHT, WIDTH);
+
+    cout << endl;
+    cout << "===== HUGE PAGE im2col CONV OUT_CHANNELS = " << OUT_CHANNELS << " =====" << endl;
+    double base_sum = 0.0, thp_sum = 0.0, prefault_sum = 0.0, explicit_sum = 0.0;
+    run<allocator<double>>("std::allocator (4 KB)", &base_sum);
+
+    huge_policy = HugePagePolicy();
+    run<HugePageAllocator<double>>("huge pages (THP)     ", &thp_sum);
+
+    huge_policy.prefault = true;
+    run<HugePageAllocator<double>>("huge pages + prefault", &prefault_sum);
+
+    huge_policy.explicit_pages = true;
+    run<HugePageAllocator<double>>("hugetlb pool + prefault", &explicit_sum);
+
+    assert(base_sum == thp_sum && base_sum == prefault_sum && base_sum == explicit_sum);
+    cout << endl;
+
+    return 0;
+}
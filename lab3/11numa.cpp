@@ -0,0 +1,291 @@
+#include <sys/time.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <cassert>
+
+using namespace std;
+
+/*
+ NUMA-aware multithreaded conv. The node / CPU topology is read from sysfs and one
+ worker is pinned to every CPU. Each node gets its own copy of the input and the
+ kernel matrix, first-touched by a worker of that node, and the output channels are
+ split so every worker computes and first-touches a contiguous output slice on its
+ own node. The naive variant allocates and zero-fills everything from the main
+ thread with unpinned workers, which puts every page on the main thread's node.
+
+ Placement is checked afterwards with move_pages(), and the bytes each worker reads
+ and writes are reported as local or remote. Only raw syscalls are used, so no libnuma.
+*/
+
+// INITIALIZE paras
+size_t HEIGHT = 64;
+size_t WIDTH = 4096;
+size_t OUT_CHANNELS = 256;
+size_t KERNEL_SIZE = 3;
+int iterations = 4;
+
+double get_time() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+// PARSE a sysfs cpu or node list like "0-3,8-11"
+vector<int> parse_cpulist(const string& text) {
+    vector<int> cpus;
+    stringstream ss(text);
+    string range;
+    while (getline(ss, range, ',')) {
+        if (range.empty() || range == "\n") continue;
+        size_t dash = range.find('-');
+        int lo = stoi(range.substr(0, dash));
+        int hi = dash == string::npos ? lo : stoi(range.substr(dash + 1));
+        for (int c = lo; c <= hi; ++c) cpus.push_back(c);
+    }
+    return cpus;
+}
+
+// A NUMA node with CPUs, id is the kernel's node number (ids can have gaps)
+struct NumaNode {
+    int id;
+    vector<int> cpus;
+};
+
+// NODES that have CPUs, listed by sysfs has_cpu, a single node 0 with all CPUs when sysfs has no node directory.
+// CPU-less nodes (CXL / PMEM memory) are not in has_cpu, they get no workers and no replica.
+vector<NumaNode> numa_topology() {
+    vector<NumaNode> nodes;
+    ifstream has_cpu("/sys/devices/system/node/has_cpu");
+    string ids;
+    if (has_cpu.is_open()) getline(has_cpu, ids);
+    for (int node : parse_cpulist(ids)) {
+        ifstream file("/sys/devices/system/node/node" + to_string(node) + "/cpulist");
+        string text;
+        if (!file.is_open() || !getline(file, text)) continue;
+        vector<int> cpus = parse_cpulist(text);
+        if (!cpus.empty()) nodes.push_back({ node, cpus });
+    }
+    if (nodes.empty()) {
+        nodes.push_back({ 0, {} });
+        for (unsigned c = 0; c < max(1u, thread::hardware_concurrency()); ++c) nodes[0].cpus.push_back(c);
+    }
+    return nodes;
+}
+
+atomic<int> pin_failures(0);
+
+// PIN the calling thread, a failure (CPU offline or outside the cpuset) is counted and reported
+bool pin_to_cpu(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0) return true;
+    ++pin_failures;
+    return false;
+}
+
+// NODE of every page in [p, p + bytes), -1 for pages that are not resident
+vector<int> page_nodes(const void* p, size_t bytes) {
+    size_t page = sysconf(_SC_PAGESIZE);
+    uintptr_t begin = reinterpret_cast<uintptr_t>(p) / page * page;
+    size_t count = (reinterpret_cast<uintptr_t>(p) + bytes - begin + page - 1) / page;
+    vector<void*> pages(count);
+    vector<int> status(count, -1);
+    for (size_t i = 0; i < count; ++i) pages[i] = reinterpret_cast<void*>(begin + i * page);
+    if (syscall(SYS_move_pages, 0, count, pages.data(), nullptr, status.data(), 0) != 0) return vector<int>(count, -1);
+    return status;
+}
+
+// UNTOUCHED anonymous memory, pages land on the node of the first writer
+double* map_untouched(size_t count) {
+    void* p = mmap(nullptr, count * sizeof(double), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    assert(p != MAP_FAILED);
+    return static_cast<double*>(p);
+}
+
+vector<double> cloud(HEIGHT * WIDTH);
+
+void init(const string& filename, size_t rows, size_t cols) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Failed to open file: " << filename << endl;
+        return;
+    }
+
+    string line;
+    size_t row = 0;
+
+    while (getline(file, line)) { // split the data by line
+        if (row >= rows) break;
+        stringstream ss(line);
+        string value;
+        size_t col = 0;
+
+        while (getline(ss, value, ',')) { // split each line by ","
+            if (col >= cols) break;
+            cloud[row * cols + col] = round(stod(value));
+            col++;
+        }
+        row++;
+    }
+
+    file.close();
+}
+
+// DIRECT conv of out channels [oc0, oc1) into output[oc][oh][ow]
+void conv_slice(const double* input, const double* kernel, double* output, int oc0, int oc1) {
+    int K = KERNEL_SIZE, width = WIDTH;
+    int out_height = HEIGHT - K + 1, out_width = WIDTH - K + 1;
+    for (int oc = oc0; oc < oc1; ++oc) {
+        const double* k = &kernel[size_t(oc) * K * K];
+        for (int oh = 0; oh < out_height; ++oh) {
+            double* out_row = &output[(size_t(oc) * out_height + oh) * out_width];
+            for (int ow = 0; ow < out_width; ++ow) out_row[ow] = 0.0;
+            for (int kh = 0; kh < K; ++kh) {
+                const double* in_row = &input[size_t(oh + kh) * width];
+                for (int kw = 0; kw < K; ++kw) {
+                    double w = k[kh * K + kw];
+                    for (int ow = 0; ow < out_width; ++ow) out_row[ow] += in_row[ow + kw] * w;
+                }
+            }
+        }
+    }
+}
+
+struct Worker {
+    int cpu;
+    int replica; // index into the node list, selects the input / kernel copy
+    int node;    // kernel node id, compared with the page placement
+    int oc0, oc1;
+};
+
+struct Placement {
+    const double* input;  // replica used by this worker
+    const double* kernel; // replica used by this worker
+};
+
+// COUNT the bytes a worker touches on its own node versus other nodes
+void account(const Worker& w, const Placement& p, const double* output, size_t in_bytes, size_t kernel_bytes,
+             size_t slice_bytes, double& local, double& remote) {
+    auto add = [&](const void* ptr, size_t bytes) {
+        vector<int> nodes = page_nodes(ptr, bytes);
+        size_t on_node = 0;
+        for (int n : nodes) on_node += n == w.node;
+        double share = nodes.empty() ? 0.0 : double(on_node) / nodes.size();
+        local += bytes * share;
+        remote += bytes * (1.0 - share);
+    };
+    add(p.input, in_bytes);
+    add(p.kernel, kernel_bytes);
+    add(output, slice_bytes);
+}
+
+int main() {
+    string filename = "pointcloud.csv";
+    init(filename, HEIGHT, WIDTH);
+
+    vector<NumaNode> nodes = numa_topology();
+    vector<Worker> workers;
+    for (size_t n = 0; n < nodes.size(); ++n)
+        for (int cpu : nodes[n].cpus) workers.push_back({ cpu, int(n), nodes[n].id, 0, 0 });
+    int num_workers = workers.size();
+    for (int t = 0; t < num_workers; ++t) {
+        workers[t].oc0 = OUT_CHANNELS * t / num_workers;
+        workers[t].oc1 = OUT_CHANNELS * (t + 1) / num_workers;
+    }
+
+    size_t out_height = HEIGHT - KERNEL_SIZE + 1, out_width = WIDTH - KERNEL_SIZE + 1;
+    size_t plane = out_height * out_width;
+    size_t in_count = HEIGHT * WIDTH, kernel_count = OUT_CHANNELS * KERNEL_SIZE * KERNEL_SIZE;
+
+    cout << endl;
+    cout << "===== NUMA CONV OUT_CHANNELS = " << OUT_CHANNELS << ", nodes = " << nodes.size() << ", workers = " << num_workers << " =====" << endl;
+
+    double naive_sum = 0.0, numa_sum = 0.0;
+    for (int numa_aware = 0; numa_aware <= 1; ++numa_aware) {
+        double* output = map_untouched(OUT_CHANNELS * plane);
+        vector<double*> inputs(nodes.size()), kernels(nodes.size());
+
+        if (!numa_aware) {
+            // NAIVE: main thread allocates and initializes everything, workers float
+            inputs[0] = map_untouched(in_count);
+            kernels[0] = map_untouched(kernel_count);
+            copy(cloud.begin(), cloud.end(), inputs[0]);
+            fill(kernels[0], kernels[0] + kernel_count, 0.5);
+            fill(output, output + OUT_CHANNELS * plane, 0.0);
+            for (size_t n = 1; n < nodes.size(); ++n) { inputs[n] = inputs[0]; kernels[n] = kernels[0]; }
+        } else {
+            // AWARE: the first worker of each node first-touches that node's replicas
+            vector<thread> setup;
+            for (size_t n = 0; n < nodes.size(); ++n) {
+                setup.emplace_back([&, n] {
+                    pin_to_cpu(nodes[n].cpus[0]);
+                    inputs[n] = map_untouched(in_count);
+                    kernels[n] = map_untouched(kernel_count);
+                    copy(cloud.begin(), cloud.end(), inputs[n]);
+                    fill(kernels[n], kernels[n] + kernel_count, 0.5);
+                });
+            }
+            for (auto& t : setup) t.join();
+            // and every pinned worker zero-fills its own output slice so it lands on its node
+            setup.clear();
+            for (const Worker& w : workers) {
+                setup.emplace_back([&, w] {
+                    pin_to_cpu(w.cpu);
+                    fill(output + w.oc0 * plane, output + w.oc1 * plane, 0.0);
+                });
+            }
+            for (auto& t : setup) t.join();
+        }
+
+        double total_time = 0.0;
+        for (int iter = 0; iter < iterations; ++iter) {
+            auto t0 = get_time();
+            vector<thread> pool;
+            for (const Worker& w : workers) {
+                pool.emplace_back([&, w] {
+                    if (numa_aware) pin_to_cpu(w.cpu);
+                    conv_slice(inputs[w.replica], kernels[w.replica], output, w.oc0, w.oc1);
+                });
+            }
+            for (auto& t : pool) t.join();
+            total_time += get_time() - t0;
+        }
+
+        if (pin_failures) cerr << "pthread_setaffinity_np failed " << pin_failures << " times, those workers ran unpinned" << endl;
+        pin_failures = 0;
+        double local = 0.0, remote = 0.0, checksum = 0.0;
+        for (const Worker& w : workers) {
+            Placement p = { inputs[w.replica], kernels[w.replica] };
+            account(w, p, output + w.oc0 * plane, in_count * sizeof(double), kernel_count * sizeof(double),
+                    (w.oc1 - w.oc0) * plane * sizeof(double), local, remote);
+        }
+        for (size_t i = 0; i < OUT_CHANNELS * plane; ++i) checksum += output[i];
+        (numa_aware ? numa_sum : naive_sum) = checksum;
+
+        cout << (numa_aware ? "numa-aware" : "naive     ") << "\tTime: " << total_time / iterations << "s\tlocal: "
+             << local / (1 << 20) << " MB\tremote: " << remote / (1 << 20) << " MB (" << 100.0 * remote / max(1.0, local + remote) << "% remote)" << endl;
+
+        munmap(output, OUT_CHANNELS * plane * sizeof(double));
+        size_t replicas = numa_aware ? nodes.size() : 1;
+        for (size_t n = 0; n < replicas; ++n) {
+            munmap(inputs[n], in_count * sizeof(double));
+            munmap(kernels[n], kernel_count * sizeof(double));
+        }
+    }
+    assert(naive_sum == numa_sum);
+    cout << endl;
+
+    return 0;
+}
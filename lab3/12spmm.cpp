@@ -0,0 +1,262 @@
+#include <sys/time.h>
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <cassert>
+
+using namespace std;
+
+/*
+ Pruned-weight convolution. The kernel matrix [OC x C*K*K] is stored in CSR, or in
+ blocked CSR with 4 output channels per block, and multiplied against the im2col
+ activations laid out as [C*K*K x pixels] so every nonzero weight is one contiguous
+ axpy over a tile of pixels. A sparsity sweep compares both against the dense GEMM
+ with the same loop structure and reports where the sparse path overtakes it.
+
+ As in 8grouped.cpp the point cloud is viewed as 64 channels of 64x64, which gives
+ the kernel matrix a shared dimension worth pruning (64 * 3 * 3 = 576).
+*/
+
+// INITIALIZE paras
+size_t CHANNELS = 64;
+size_t HEIGHT = 64;
+size_t WIDTH = 64;
+size_t OUT_CHANNELS = 256;
+size_t KERNEL_SIZE = 3;
+size_t STRIDE = 1;
+size_t PADDING = 1;
+int iterations = 8;
+const int PIXEL_TILE = 256;
+const int BLOCK_ROWS = 4;
+
+double get_time() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+vector<vector<vector<double>>> input(CHANNELS, vector<vector<double>>(HEIGHT, vector<double>(WIDTH)));
+
+// READ pointcloud.csv, row x holds the 64x64 (y, z) slice of voxel channel x
+void init(const string& filename) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Failed to open file: " << filename << endl;
+        return;
+    }
+
+    string line;
+    size_t row = 0;
+
+    while (getline(file, line)) { // split the data by line
+        if (row >= CHANNELS) break;
+        stringstream ss(line);
+        string value;
+        size_t col = 0;
+
+        while (getline(ss, value, ',')) { // split each line by ","
+            if (col >= HEIGHT * WIDTH) break;
+            input[row][col / WIDTH][col % WIDTH] = round(stod(value));
+            col++;
+        }
+        row++;
+    }
+
+    file.close();
+}
+
+// Convert the feature map to the transposed column matrix, cols[k * pixels + p]
+vector<double> im2col_t(int& pixels, int& col_height) {
+    int K = KERNEL_SIZE, S = STRIDE, P = PADDING, height = HEIGHT, width = WIDTH;
+    int out_height = (height - K + 2 * P) / S + 1;
+    int out_width = (width - K + 2 * P) / S + 1;
+    pixels = out_height * out_width;
+    col_height = CHANNELS * K * K;
+    vector<double> cols(size_t(col_height) * pixels, 0.0);
+    for (int ic = 0; ic < int(CHANNELS); ++ic)
+        for (int kh = 0; kh < K; ++kh)
+            for (int kw = 0; kw < K; ++kw) {
+                double* row = &cols[size_t((ic * K + kh) * K + kw) * pixels];
+                for (int oh = 0; oh < out_height; ++oh)
+                    for (int ow = 0; ow < out_width; ++ow) {
+                        int h_offset = oh * S + kh - P;
+                        int w_offset = ow * S + kw - P;
+                        if (h_offset >= 0 && h_offset < height && w_offset >= 0 && w_offset < width)
+                            row[oh * out_width + ow] = input[ic][h_offset][w_offset];
+                    }
+            }
+    return cols;
+}
+
+struct CSRMatrix {
+    int rows = 0, cols = 0;
+    vector<int> row_ptr, col_idx;
+    vector<double> values;
+};
+
+// Blocked CSR: BLOCK_ROWS consecutive output channels share one column index per block
+struct BCSRMatrix {
+    int rows = 0, cols = 0;
+    vector<int> block_ptr, col_idx;
+    vector<double> values; // BLOCK_ROWS values per block, zero-filled where a row has no weight
+};
+
+CSRMatrix dense_to_csr(const vector<double>& dense, int rows, int cols) {
+    CSRMatrix m;
+    m.rows = rows;
+    m.cols = cols;
+    m.row_ptr.push_back(0);
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            double v = dense[size_t(r) * cols + c];
+            if (v != 0.0) {
+                m.col_idx.push_back(c);
+                m.values.push_back(v);
+            }
+        }
+        m.row_ptr.push_back(m.col_idx.size());
+    }
+    return m;
+}
+
+BCSRMatrix dense_to_bcsr(const vector<double>& dense, int rows, int cols) {
+    assert(rows % BLOCK_ROWS == 0);
+    BCSRMatrix m;
+    m.rows = rows;
+    m.cols = cols;
+    m.block_ptr.push_back(0);
+    for (int r0 = 0; r0 < rows; r0 += BLOCK_ROWS) {
+        for (int c = 0; c < cols; ++c) {
+            bool any = false;
+            for (int r = 0; r < BLOCK_ROWS; ++r) any = any || dense[size_t(r0 + r) * cols + c] != 0.0;
+            if (!any) continue;
+            m.col_idx.push_back(c);
+            for (int r = 0; r < BLOCK_ROWS; ++r) m.values.push_back(dense[size_t(r0 + r) * cols + c]);
+        }
+        m.block_ptr.push_back(m.col_idx.size());
+    }
+    return m;
+}
+
+// DENSE GEMM: out[oc][p] = sum_k W[oc][k] * cols[k][p], pixel-tiled
+void gemm_dense(const vector<double>& W, int rows, int shared, const vector<double>& cols, int pixels, vector<double>& out) {
+    for (int p0 = 0; p0 < pixels; p0 += PIXEL_TILE) {
+        int p1 = min(pixels, p0 + PIXEL_TILE);
+        for (int oc = 0; oc < rows; ++oc) {
+            double* dst = &out[size_t(oc) * pixels];
+            for (int p = p0; p < p1; ++p) dst[p] = 0.0;
+            for (int k = 0; k < shared; ++k) {
+                double w = W[size_t(oc) * shared + k];
+                const double* src = &cols[size_t(k) * pixels];
+                for (int p = p0; p < p1; ++p) dst[p] += w * src[p];
+            }
+        }
+    }
+}
+
+// SPMM with CSR weights, only nonzero weights issue an axpy
+void spmm_csr(const CSRMatrix& W, const vector<double>& cols, int pixels, vector<double>& out) {
+    for (int p0 = 0; p0 < pixels; p0 += PIXEL_TILE) {
+        int p1 = min(pixels, p0 + PIXEL_TILE);
+        for (int oc = 0; oc < W.rows; ++oc) {
+            double* dst = &out[size_t(oc) * pixels];
+            for (int p = p0; p < p1; ++p) dst[p] = 0.0;
+            for (int i = W.row_ptr[oc]; i < W.row_ptr[oc + 1]; ++i) {
+                double w = W.values[i];
+                const double* src = &cols[size_t(W.col_idx[i]) * pixels];
+                for (int p = p0; p < p1; ++p) dst[p] += w * src[p];
+            }
+        }
+    }
+}
+
+// SPMM with blocked CSR, each loaded activation row updates BLOCK_ROWS outputs
+void spmm_bcsr(const BCSRMatrix& W, const vector<double>& cols, int pixels, vector<double>& out) {
+    for (int p0 = 0; p0 < pixels; p0 += PIXEL_TILE) {
+        int p1 = min(pixels, p0 + PIXEL_TILE);
+        for (int b = 0; b < W.rows / BLOCK_ROWS; ++b) {
+            double* __restrict__ d0 = &out[size_t(b * BLOCK_ROWS + 0) * pixels];
+            double* __restrict__ d1 = &out[size_t(b * BLOCK_ROWS + 1) * pixels];
+            double* __restrict__ d2 = &out[size_t(b * BLOCK_ROWS + 2) * pixels];
+            double* __restrict__ d3 = &out[size_t(b * BLOCK_ROWS + 3) * pixels];
+            for (int p = p0; p < p1; ++p) d0[p] = d1[p] = d2[p] = d3[p] = 0.0;
+            for (int i = W.block_ptr[b]; i < W.block_ptr[b + 1]; ++i) {
+                const double w0 = W.values[size_t(i) * BLOCK_ROWS], w1 = W.values[size_t(i) * BLOCK_ROWS + 1];
+                const double w2 = W.values[size_t(i) * BLOCK_ROWS + 2], w3 = W.values[size_t(i) * BLOCK_ROWS + 3];
+                const double* __restrict__ src = &cols[size_t(W.col_idx[i]) * pixels];
+                for (int p = p0; p < p1; ++p) {
+                    double x = src[p];
+                    d0[p] += w0 * x;
+                    d1[p] += w1 * x;
+                    d2[p] += w2 * x;
+                    d3[p] += w3 * x;
+                }
+            }
+        }
+    }
+}
+
+// PRUNE: keep each weight with probability 1 - sparsity (unstructured magnitude-free pruning)
+vector<double> make_pruned_kernel(int rows, int cols, double sparsity, unsigned seed) {
+    srand(seed);
+    vector<double> W(size_t(rows) * cols, 0.0);
+    for (size_t i = 0; i < W.size(); ++i) {
+        if (rand() / (RAND_MAX + 1.0) >= sparsity) W[i] = 0.25 + 0.5 * (rand() / (RAND_MAX + 1.0));
+    }
+    return W;
+}
+
+void test(const vector<double>& out, const vector<double>& truth) {
+    for (size_t i = 0; i < truth.size(); ++i) assert(fabs(out[i] - truth[i]) < 1e-9);
+}
+
+template <typename F>
+double time_avg(F&& f) {
+    double total = 0.0;
+    for (int iter = 0; iter < iterations; iter++) {
+        auto t = get_time();
+        f();
+        total += get_time() - t;
+    }
+    return total / iterations;
+}
+
+int main() {
+    init("pointcloud.csv");
+    int pixels = 0, shared = 0;
+    vector<double> cols = im2col_t(pixels, shared);
+    int rows = OUT_CHANNELS;
+    vector<double> out_dense(size_t(rows) * pixels), out_sparse(size_t(rows) * pixels);
+
+    cout << endl;
+    cout << "===== PRUNED-WEIGHT CONV OC = " << rows << ", C*K*K = " << shared << ", pixels = " << pixels << " =====" << endl;
+    cout << "sparsity\tdense\t\tcsr\t\tbcsr(4x1)\tbcsr fill" << endl;
+    double csr_crossover = -1.0, bcsr_crossover = -1.0;
+    for (double sparsity : { 0.0, 0.3, 0.5, 0.6, 0.7, 0.8, 0.85, 0.9, 0.95, 0.99 }) {
+        vector<double> W = make_pruned_kernel(rows, shared, sparsity, 5743);
+        CSRMatrix csr = dense_to_csr(W, rows, shared);
+        BCSRMatrix bcsr = dense_to_bcsr(W, rows, shared);
+
+        gemm_dense(W, rows, shared, cols, pixels, out_dense);
+        spmm_csr(csr, cols, pixels, out_sparse);
+        test(out_sparse, out_dense);
+        spmm_bcsr(bcsr, cols, pixels, out_sparse);
+        test(out_sparse, out_dense);
+
+        double dense_time = time_avg([&] { gemm_dense(W, rows, shared, cols, pixels, out_dense); });
+        double csr_time = time_avg([&] { spmm_csr(csr, cols, pixels, out_sparse); });
+        double bcsr_time = time_avg([&] { spmm_bcsr(bcsr, cols, pixels, out_sparse); });
+        if (csr_crossover < 0 && csr_time < dense_time) csr_crossover = sparsity;
+        if (bcsr_crossover < 0 && bcsr_time < dense_time) bcsr_crossover = sparsity;
+
+        // FILL: stored block values per true nonzero, 1.0 means no padding zeros
+        double fill = csr.values.empty() ? 1.0 : double(bcsr.values.size()) / csr.values.size();
+        cout << sparsity << "\t\t" << dense_time << "s\t" << csr_time << "s\t" << bcsr_time << "s\t" << fill << endl;
+    }
+    cout << "###@@@ CSR overtakes dense from sparsity " << csr_crossover << ", BCSR from sparsity " << bcsr_crossover << " (-1: never)." << endl;
+    cout << endl;
+
+    return 0;
+}
@@ -0,0 +1,415 @@
+#include <sys/time.h>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+/*
+ Separable / low-rank filter execution. prepare_filters() runs a Jacobi SVD on every
+ K x K filter slice and picks the cheapest exact-enough form:
+   BOX      all taps equal: c * window sum read from an integral image, O(1) per output
+   LOW_RANK sum of r outer products col_t * row_t^T with 2rK < K*K: r row passes
+            followed by r column passes, 2rK per output
+   GENERAL  everything else, plain K*K direct conv
+ The rank is the smallest r whose dropped singular values stay below `tolerance`
+ relative to the filter's Frobenius norm, so tolerance 0 keeps only exact low-rank forms.
+*/
+
+// INITIALIZE paras
+size_t BATCH = 1;
+size_t HEIGHT = 64;
+size_t WIDTH = 4096;
+size_t IN_CHANNELS = 1;
+size_t OUT_CHANNELS = 64;
+size_t KERNEL_SIZE = 5;
+size_t STRIDE = 1;
+size_t PADDING = 2;
+int iterations = 8;
+
+double get_time() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+typedef vector<vector<vector<vector<double>>>> Tensor4D;
+
+Tensor4D input(BATCH, vector<vector<vector<double>>>(IN_CHANNELS, vector<vector<double>>(HEIGHT, vector<double>(WIDTH))));
+
+void init(const string& filename, size_t rows, size_t cols) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Failed to open file: " << filename << endl;
+        return;
+    }
+
+    string line;
+    size_t row = 0;
+
+    while (getline(file, line)) { // split the data by line
+        if (row >= rows) break;
+        stringstream ss(line);
+        string value;
+        size_t col = 0;
+
+        while (getline(ss, value, ',')) { // split each line by ","
+            if (col >= cols) break;
+            input[0][0][row][col] = round(stod(value));
+            col++;
+        }
+        row++;
+    }
+
+    file.close();
+}
+
+// DEFINE generic conv function, the reference for every decomposed path
+Tensor4D conv2d(const Tensor4D& input, const Tensor4D& kernel, int STRIDE, int PADDING) {
+    int batch = input.size();
+    int in_channels = input[0].size();
+    int height = input[0][0].size();
+    int width = input[0][0][0].size();
+    int out_channels = kernel.size();
+    int kernel_size = kernel[0][0].size();
+    int out_height = (height - kernel_size + 2 * PADDING) / STRIDE + 1;
+    int out_width = (width - kernel_size + 2 * PADDING) / STRIDE + 1;
+
+    Tensor4D output(batch, vector<vector<vector<double>>>(out_channels, vector<vector<double>>(out_height, vector<double>(out_width, 0))));
+
+    for (int b = 0; b < batch; ++b) {
+        for (int oc = 0; oc < out_channels; ++oc) {
+            for (int oh = 0; oh < out_height; ++oh) {
+                for (int ow = 0; ow < out_width; ++ow) {
+                    for (int ic = 0; ic < in_channels; ++ic) {
+                        for (int kh = 0; kh < kernel_size; ++kh) {
+                            for (int kw = 0; kw < kernel_size; ++kw) {
+                                int h_offset = oh * STRIDE + kh - PADDING;
+                                int w_offset = ow * STRIDE + kw - PADDING;
+
+                                if (h_offset >= 0 && h_offset < height && w_offset >= 0 && w_offset < width) {
+                                    output[b][oc][oh][ow] +=
+                                        input[b][ic][h_offset][w_offset] * kernel[oc][ic][kh][kw];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return output;
+}
+
+// SVD of a K x K matrix by one-sided Jacobi: A = U diag(S) V^T, singular values sorted descending
+void svd_jacobi(const vector<vector<double>>& A, vector<vector<double>>& U, vector<double>& S, vector<vector<double>>& V) {
+    int K = A.size();
+    U = A;
+    V.assign(K, vector<double>(K, 0.0));
+    for (int i = 0; i < K; ++i) V[i][i] = 1.0;
+
+    for (int sweep = 0; sweep < 60; ++sweep) {
+        double off = 0.0;
+        for (int p = 0; p < K - 1; ++p) {
+            for (int q = p + 1; q < K; ++q) {
+                double alpha = 0.0, beta = 0.0, gamma = 0.0;
+                for (int i = 0; i < K; ++i) {
+                    alpha += U[i][p] * U[i][p];
+                    beta += U[i][q] * U[i][q];
+                    gamma += U[i][p] * U[i][q];
+                }
+                if (gamma == 0.0 || fabs(gamma) <= 1e-15 * sqrt(alpha * beta)) continue;
+                off = max(off, fabs(gamma) / sqrt(alpha * beta));
+                // ROTATE columns p and q so they become orthogonal
+                double zeta = (beta - alpha) / (2.0 * gamma);
+                double t = (zeta >= 0 ? 1.0 : -1.0) / (fabs(zeta) + sqrt(1.0 + zeta * zeta));
+                double c = 1.0 / sqrt(1.0 + t * t), s = c * t;
+                for (int i = 0; i < K; ++i) {
+                    double up = U[i][p], uq = U[i][q];
+                    U[i][p] = c * up - s * uq;
+                    U[i][q] = s * up + c * uq;
+                    double vp = V[i][p], vq = V[i][q];
+                    V[i][p] = c * vp - s * vq;
+                    V[i][q] = s * vp + c * vq;
+                }
+            }
+        }
+        if (off < 1e-15) break;
+    }
+
+    // NORMALIZE columns of U, the norms are the singular values
+    S.assign(K, 0.0);
+    for (int j = 0; j < K; ++j) {
+        for (int i = 0; i < K; ++i) S[j] += U[i][j] * U[i][j];
+        S[j] = sqrt(S[j]);
+        for (int i = 0; i < K; ++i) U[i][j] = S[j] > 0 ? U[i][j] / S[j] : 0.0;
+    }
+
+    vector<int> order(K);
+    for (int j = 0; j < K; ++j) order[j] = j;
+    sort(order.begin(), order.end(), [&](int a, int b) { return S[a] > S[b]; });
+    vector<vector<double>> U2(K, vector<double>(K)), V2(K, vector<double>(K));
+    vector<double> S2(K);
+    for (int j = 0; j < K; ++j) {
+        S2[j] = S[order[j]];
+        for (int i = 0; i < K; ++i) {
+            U2[i][j] = U[i][order[j]];
+            V2[i][j] = V[i][order[j]];
+        }
+    }
+    U = U2;
+    S = S2;
+    V = V2;
+}
+
+enum FilterKind { BOX, LOW_RANK, GENERAL };
+
+// Execution form of one [oc][ic] filter slice
+struct FilterPlan {
+    FilterKind kind = GENERAL;
+    double box = 0.0;                  // BOX: the common tap value
+    vector<vector<double>> cols, rows; // LOW_RANK: term t is cols[t] (length K, scaled by sigma) x rows[t]
+    double error = 0.0;                // relative Frobenius error of the chosen form
+};
+
+FilterPlan plan_filter(const vector<vector<double>>& f, double tolerance) {
+    int K = f.size();
+    FilterPlan plan;
+
+    bool constant = true;
+    for (int kh = 0; kh < K; ++kh)
+        for (int kw = 0; kw < K; ++kw) constant = constant && f[kh][kw] == f[0][0];
+    if (constant) {
+        plan.kind = BOX;
+        plan.box = f[0][0];
+        return plan;
+    }
+
+    vector<vector<double>> U, V;
+    vector<double> S;
+    svd_jacobi(f, U, S, V);
+    double norm2 = 0.0;
+    for (double s : S) norm2 += s * s;
+
+    // RANK: fewest terms whose dropped energy is within tolerance
+    int rank = K;
+    double dropped = 0.0;
+    for (int r = K - 1; r >= 0; --r) {
+        if (sqrt(dropped + S[r] * S[r]) > tolerance * sqrt(norm2) + 1e-12 * sqrt(norm2)) break;
+        dropped += S[r] * S[r];
+        rank = r;
+    }
+    if (2 * rank * K >= K * K) return plan; // no cheaper than direct
+
+    plan.kind = LOW_RANK;
+    plan.error = norm2 > 0 ? sqrt(dropped / norm2) : 0.0;
+    for (int t = 0; t < rank; ++t) {
+        vector<double> col(K), row(K);
+        for (int i = 0; i < K; ++i) {
+            col[i] = S[t] * U[i][t];
+            row[i] = V[i][t];
+        }
+        plan.cols.push_back(col);
+        plan.rows.push_back(row);
+    }
+    return plan;
+}
+
+// PREPARE: analyze every filter slice once, plans[oc][ic]
+vector<vector<FilterPlan>> prepare_filters(const Tensor4D& kernel, double tolerance) {
+    vector<vector<FilterPlan>> plans(kernel.size());
+    for (size_t oc = 0; oc < kernel.size(); ++oc)
+        for (size_t ic = 0; ic < kernel[oc].size(); ++ic)
+            plans[oc].push_back(plan_filter(kernel[oc][ic], tolerance));
+    return plans;
+}
+
+// EXECUTE conv with the prepared plans
+Tensor4D conv2d_decomposed(const Tensor4D& input, const Tensor4D& kernel, const vector<vector<FilterPlan>>& plans,
+                           int STRIDE, int PADDING) {
+    int batch = input.size();
+    int in_channels = input[0].size();
+    int height = input[0][0].size();
+    int width = input[0][0][0].size();
+    int out_channels = kernel.size();
+    int K = kernel[0][0].size();
+    int out_height = (height - K + 2 * PADDING) / STRIDE + 1;
+    int out_width = (width - K + 2 * PADDING) / STRIDE + 1;
+    int padded_height = height + 2 * PADDING, padded_width = width + 2 * PADDING;
+
+    Tensor4D output(batch, vector<vector<vector<double>>>(out_channels, vector<vector<double>>(out_height, vector<double>(out_width, 0))));
+
+    for (int b = 0; b < batch; ++b) {
+        for (int ic = 0; ic < in_channels; ++ic) {
+            // ZERO-PADDED copy of the channel, so no pass needs bounds checks
+            vector<double> padded(size_t(padded_height) * padded_width, 0.0);
+            for (int h = 0; h < height; ++h)
+                copy(input[b][ic][h].begin(), input[b][ic][h].end(), padded.begin() + size_t(h + PADDING) * padded_width + PADDING);
+
+            // INTEGRAL image of the padded channel, built once for all box filters
+            vector<double> sat;
+            bool any_box = false;
+            for (int oc = 0; oc < out_channels; ++oc) any_box = any_box || plans[oc][ic].kind == BOX;
+            if (any_box) {
+                sat.assign(size_t(padded_height + 1) * (padded_width + 1), 0.0);
+                for (int h = 0; h < padded_height; ++h) {
+                    double row_sum = 0.0;
+                    for (int w = 0; w < padded_width; ++w) {
+                        row_sum += padded[size_t(h) * padded_width + w];
+                        sat[size_t(h + 1) * (padded_width + 1) + w + 1] = sat[size_t(h) * (padded_width + 1) + w + 1] + row_sum;
+                    }
+                }
+            }
+
+            vector<double> rowpass(size_t(padded_height) * out_width);
+            for (int oc = 0; oc < out_channels; ++oc) {
+                const FilterPlan& plan = plans[oc][ic];
+                vector<vector<double>>& out = output[b][oc];
+
+                if (plan.kind == BOX) {
+                    for (int oh = 0; oh < out_height; ++oh) {
+                        const double* top = &sat[size_t(oh * STRIDE) * (padded_width + 1)];
+                        const double* bottom = &sat[size_t(oh * STRIDE + K) * (padded_width + 1)];
+                        for (int ow = 0; ow < out_width; ++ow) {
+                            int w0 = ow * STRIDE, w1 = w0 + K;
+                            out[oh][ow] += plan.box * (bottom[w1] - bottom[w0] - top[w1] + top[w0]);
+                        }
+                    }
+                } else if (plan.kind == LOW_RANK) {
+                    for (size_t t = 0; t < plan.rows.size(); ++t) {
+                        // ROW pass: 1D filter along the width for every padded input row
+                        const double* row = plan.rows[t].data();
+                        for (int h = 0; h < padded_height; ++h) {
+                            const double* src = &padded[size_t(h) * padded_width];
+                            double* dst = &rowpass[size_t(h) * out_width];
+                            for (int ow = 0; ow < out_width; ++ow) {
+                                double acc = 0.0;
+                                for (int kw = 0; kw < K; ++kw) acc += src[ow * STRIDE + kw] * row[kw];
+                                dst[ow] = acc;
+                            }
+                        }
+                        // COLUMN pass: 1D filter along the height over the row-pass result
+                        const double* col = plan.cols[t].data();
+                        for (int oh = 0; oh < out_height; ++oh) {
+                            double* dst = out[oh].data();
+                            for (int kh = 0; kh < K; ++kh) {
+                                const double* src = &rowpass[size_t(oh * STRIDE + kh) * out_width];
+                                for (int ow = 0; ow < out_width; ++ow) dst[ow] += col[kh] * src[ow];
+                            }
+                        }
+                    }
+                } else {
+                    const vector<vector<double>>& f = kernel[oc][ic];
+                    for (int oh = 0; oh < out_height; ++oh) {
+                        double* dst = out[oh].data();
+                        for (int kh = 0; kh < K; ++kh) {
+                            const double* src = &padded[size_t(oh * STRIDE + kh) * padded_width];
+                            for (int kw = 0; kw < K; ++kw) {
+                                double w = f[kh][kw];
+                                for (int ow = 0; ow < out_width; ++ow) dst[ow] += src[ow * STRIDE + kw] * w;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return output;
+}
+
+double max_abs_diff(const Tensor4D& a, const Tensor4D& b) {
+    double diff = 0.0;
+    for (size_t oc = 0; oc < a[0].size(); ++oc)
+        for (size_t oh = 0; oh < a[0][oc].size(); ++oh)
+            for (size_t ow = 0; ow < a[0][oc][oh].size(); ++ow)
+                diff = max(diff, fabs(a[0][oc][oh][ow] - b[0][oc][oh][ow]));
+    return diff;
+}
+
+double uniform() { return rand() / (RAND_MAX + 1.0) - 0.5; }
+
+// FILTER banks of OUT_CHANNELS x IN_CHANNELS slices, each slice built by `make`
+template <typename F>
+Tensor4D make_kernel(F&& make) {
+    Tensor4D kernel(OUT_CHANNELS, vector<vector<vector<double>>>(IN_CHANNELS, vector<vector<double>>(KERNEL_SIZE, vector<double>(KERNEL_SIZE))));
+    for (size_t oc = 0; oc < OUT_CHANNELS; ++oc)
+        for (size_t ic = 0; ic < IN_CHANNELS; ++ic) kernel[oc][ic] = make();
+    return kernel;
+}
+
+vector<vector<double>> rank_r_filter(int r, double noise) {
+    int K = KERNEL_SIZE;
+    vector<vector<double>> f(K, vector<double>(K, 0.0));
+    for (int t = 0; t < r; ++t) {
+        vector<double> u(K), v(K);
+        for (int i = 0; i < K; ++i) { u[i] = uniform(); v[i] = uniform(); }
+        for (int kh = 0; kh < K; ++kh)
+            for (int kw = 0; kw < K; ++kw) f[kh][kw] += u[kh] * v[kw];
+    }
+    for (int kh = 0; kh < K; ++kh)
+        for (int kw = 0; kw < K; ++kw) f[kh][kw] += noise * uniform();
+    return f;
+}
+
+int main() {
+    string filename = "pointcloud.csv";
+    init(filename, HEIGHT, WIDTH);
+    srand(5743);
+
+    struct Case { string name; Tensor4D kernel; double tolerance; };
+    vector<Case> cases;
+    cases.push_back({ "box 0.5 (lab filter)", make_kernel([] { return vector<vector<double>>(KERNEL_SIZE, vector<double>(KERNEL_SIZE, 0.5)); }), 0.0 });
+    cases.push_back({ "rank-1 separable   ", make_kernel([] { return rank_r_filter(1, 0.0); }), 0.0 });
+    cases.push_back({ "rank-2 exact       ", make_kernel([] { return rank_r_filter(2, 0.0); }), 0.0 });
+    cases.push_back({ "rank-1 + 1e-3 noise", make_kernel([] { return rank_r_filter(1, 1e-3); }), 1e-2 });
+    cases.push_back({ "full rank          ", make_kernel([] { return rank_r_filter(KERNEL_SIZE, 0.0); }), 0.0 });
+
+    cout << endl;
+    cout << "===== SEPARABLE / LOW-RANK CONV K = " << KERNEL_SIZE << ", OUT_CHANNELS = " << OUT_CHANNELS << " =====" << endl;
+    for (const Case& c : cases) {
+        vector<vector<FilterPlan>> plans = prepare_filters(c.kernel, c.tolerance);
+        int box = 0, low_rank = 0, general = 0, max_rank = 0;
+        double max_error = 0.0;
+        for (const auto& per_oc : plans)
+            for (const FilterPlan& p : per_oc) {
+                box += p.kind == BOX;
+                low_rank += p.kind == LOW_RANK;
+                general += p.kind == GENERAL;
+                if (p.kind == LOW_RANK) max_rank = max(max_rank, int(p.rows.size()));
+                max_error = max(max_error, p.error);
+            }
+
+        double direct_time = 0.0, decomposed_time = 0.0;
+        Tensor4D truth, output;
+        for (int iter = 0; iter < iterations; iter++) {
+            auto t = get_time();
+            truth = conv2d(input, c.kernel, STRIDE, PADDING);
+            direct_time += get_time() - t;
+
+            t = get_time();
+            output = conv2d_decomposed(input, c.kernel, plans, STRIDE, PADDING);
+            decomposed_time += get_time() - t;
+        }
+
+        // CHECK exact forms to rounding, truncated forms within their dropped energy
+        double diff = max_abs_diff(output, truth);
+        if (c.tolerance == 0.0) assert(diff < 1e-9);
+        else assert(diff < c.tolerance * KERNEL_SIZE * KERNEL_SIZE);
+
+        cout << c.name << "\tbox/low-rank/general: " << box << "/" << low_rank << "/" << general << "\tmax rank: " << max_rank
+             << "\tfilter error: " << max_error << "\tmax |diff|: " << diff << endl;
+        cout << "###@@@ Avg Time for Calculation(direct): " << direct_time / iterations << "s, (decomposed): " << decomposed_time / iterations
+             << "s, speedup: " << direct_time / decomposed_time << "x." << endl;
+    }
+    cout << endl;
+
+    return 0;
+}
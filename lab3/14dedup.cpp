@@ -0,0 +1,317 @@
+#include <sys/time.h>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include <cassert>
+
+using namespace std;
+
+/*
+ Filter deduplication across output channels. dedup_filters() hashes every filter
+ [IC][K][K] at prepare time and keeps one copy per distinct filter plus an output
+ channel -> unique filter indirection table. Any conv then only runs on the unique
+ filters; DedupOutput::channel() serves output channel oc through the table, and
+ materialize() writes the full [B][OC][OH][OW] tensor only for callers that need it.
+
+ The lab kernels (0.5 everywhere, 1024 channels) collapse to a single filter, and
+ weight-clustered kernels to one filter per cluster.
+*/
+
+// INITIALIZE paras
+size_t BATCH = 1;
+size_t HEIGHT = 64;
+size_t WIDTH = 4096;
+size_t IN_CHANNELS = 1;
+size_t OUT_CHANNELS = 128;
+size_t KERNEL_SIZE = 3;
+size_t STRIDE = 1;
+size_t PADDING = 0;
+int iterations = 4;
+
+double get_time() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+typedef vector<vector<vector<vector<double>>>> Tensor4D;
+
+Tensor4D input(BATCH, vector<vector<vector<double>>>(IN_CHANNELS, vector<vector<double>>(HEIGHT, vector<double>(WIDTH))));
+
+void init(const string& filename, size_t rows, size_t cols) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Failed to open file: " << filename << endl;
+        return;
+    }
+
+    string line;
+    size_t row = 0;
+
+    while (getline(file, line)) { // split the data by line
+        if (row >= rows) break;
+        stringstream ss(line);
+        string value;
+        size_t col = 0;
+
+        while (getline(ss, value, ',')) { // split each line by ","
+            if (col >= cols) break;
+            input[0][0][row][col] = round(stod(value));
+            col++;
+        }
+        row++;
+    }
+
+    file.close();
+}
+
+// DEFINE direct conv function, as in 2conv.cpp
+Tensor4D conv2d(const Tensor4D& input, const Tensor4D& kernel, int STRIDE, int PADDING) {
+    int batch = input.size();
+    int in_channels = input[0].size();
+    int height = input[0][0].size();
+    int width = input[0][0][0].size();
+    int out_channels = kernel.size();
+    int kernel_size = kernel[0][0].size();
+    int out_height = (height - kernel_size + 2 * PADDING) / STRIDE + 1;
+    int out_width = (width - kernel_size + 2 * PADDING) / STRIDE + 1;
+
+    Tensor4D output(batch, vector<vector<vector<double>>>(out_channels, vector<vector<double>>(out_height, vector<double>(out_width, 0))));
+
+    for (int b = 0; b < batch; ++b) {
+        for (int oc = 0; oc < out_channels; ++oc) {
+            for (int oh = 0; oh < out_height; ++oh) {
+                for (int ow = 0; ow < out_width; ++ow) {
+                    for (int ic = 0; ic < in_channels; ++ic) {
+                        for (int kh = 0; kh < kernel_size; ++kh) {
+                            for (int kw = 0; kw < kernel_size; ++kw) {
+                                int h_offset = oh * STRIDE + kh - PADDING;
+                                int w_offset = ow * STRIDE + kw - PADDING;
+
+                                if (h_offset >= 0 && h_offset < height && w_offset >= 0 && w_offset < width) {
+                                    output[b][oc][oh][ow] +=
+                                        input[b][ic][h_offset][w_offset] * kernel[oc][ic][kh][kw];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return output;
+}
+
+// EXECUTE Conv2D using im2col, as in 1im2col.cpp but with one flat column matrix
+Tensor4D conv2d_im2col(const Tensor4D& input, const Tensor4D& kernel, int STRIDE, int PADDING) {
+    int batch = input.size();
+    int in_channels = input[0].size();
+    int height = input[0][0].size();
+    int width = input[0][0][0].size();
+    int out_channels = kernel.size();
+    int K = kernel[0][0].size();
+    int out_height = (height - K + 2 * PADDING) / STRIDE + 1;
+    int out_width = (width - K + 2 * PADDING) / STRIDE + 1;
+    int col_width = in_channels * K * K;
+
+    Tensor4D output(batch, vector<vector<vector<double>>>(out_channels, vector<vector<double>>(out_height, vector<double>(out_width, 0))));
+    vector<double> col(col_width);
+    for (int b = 0; b < batch; ++b) {
+        for (int oh = 0; oh < out_height; ++oh) {
+            for (int ow = 0; ow < out_width; ++ow) {
+                int idx = 0;
+                for (int ic = 0; ic < in_channels; ++ic)
+                    for (int kh = 0; kh < K; ++kh)
+                        for (int kw = 0; kw < K; ++kw) {
+                            int h_offset = oh * STRIDE + kh - PADDING;
+                            int w_offset = ow * STRIDE + kw - PADDING;
+                            col[idx++] = (h_offset >= 0 && h_offset < height && w_offset >= 0 && w_offset < width) ? input[b][ic][h_offset][w_offset] : 0.0;
+                        }
+                for (int oc = 0; oc < out_channels; ++oc) {
+                    double sum = 0.0;
+                    idx = 0;
+                    for (int ic = 0; ic < in_channels; ++ic)
+                        for (int kh = 0; kh < K; ++kh)
+                            for (int kw = 0; kw < K; ++kw) sum += col[idx++] * kernel[oc][ic][kh][kw];
+                    output[b][oc][oh][ow] = sum;
+                }
+            }
+        }
+    }
+    return output;
+}
+
+// SCATTER conv over the nonzero inputs, the rulebook idea of 0sparse.cpp without the rulebook tables
+Tensor4D conv2d_sparse(const Tensor4D& input, const Tensor4D& kernel, int STRIDE, int PADDING) {
+    int batch = input.size();
+    int in_channels = input[0].size();
+    int height = input[0][0].size();
+    int width = input[0][0][0].size();
+    int out_channels = kernel.size();
+    int K = kernel[0][0].size();
+    int out_height = (height - K + 2 * PADDING) / STRIDE + 1;
+    int out_width = (width - K + 2 * PADDING) / STRIDE + 1;
+
+    Tensor4D output(batch, vector<vector<vector<double>>>(out_channels, vector<vector<double>>(out_height, vector<double>(out_width, 0))));
+    for (int b = 0; b < batch; ++b)
+        for (int ic = 0; ic < in_channels; ++ic)
+            for (int h = 0; h < height; ++h)
+                for (int w = 0; w < width; ++w) {
+                    double v = input[b][ic][h][w];
+                    if (v == 0.0) continue;
+                    for (int kh = 0; kh < K; ++kh)
+                        for (int kw = 0; kw < K; ++kw) {
+                            int oh = h + PADDING - kh, ow = w + PADDING - kw;
+                            if (oh < 0 || ow < 0 || oh % STRIDE || ow % STRIDE) continue;
+                            oh /= STRIDE;
+                            ow /= STRIDE;
+                            if (oh >= out_height || ow >= out_width) continue;
+                            for (int oc = 0; oc < out_channels; ++oc) output[b][oc][oh][ow] += v * kernel[oc][ic][kh][kw];
+                        }
+                }
+    return output;
+}
+
+// Distinct filters of a kernel plus the output channel -> unique filter table
+struct DedupKernel {
+    Tensor4D unique;
+    vector<int> channel_map;
+};
+
+// HASH the bit pattern of a filter, -0.0 is folded into 0.0 so equal values hash equal
+uint64_t hash_filter(const vector<vector<vector<double>>>& filter) {
+    uint64_t h = 1469598103934665603ULL; // FNV-1a
+    for (const auto& plane : filter)
+        for (const auto& row : plane)
+            for (double v : row) {
+                if (v == 0.0) v = 0.0;
+                uint64_t bits;
+                memcpy(&bits, &v, sizeof(bits));
+                for (int i = 0; i < 8; ++i) {
+                    h ^= (bits >> (8 * i)) & 0xff;
+                    h *= 1099511628211ULL;
+                }
+            }
+    return h;
+}
+
+// PREPARE: bucket filters by hash, compare exactly inside a bucket
+DedupKernel dedup_filters(const Tensor4D& kernel) {
+    DedupKernel d;
+    unordered_map<uint64_t, vector<int>> buckets;
+    for (size_t oc = 0; oc < kernel.size(); ++oc) {
+        vector<int>& bucket = buckets[hash_filter(kernel[oc])];
+        int id = -1;
+        for (int u : bucket)
+            if (d.unique[u] == kernel[oc]) { id = u; break; }
+        if (id < 0) {
+            id = d.unique.size();
+            d.unique.push_back(kernel[oc]);
+            bucket.push_back(id);
+        }
+        d.channel_map.push_back(id);
+    }
+    return d;
+}
+
+// Output over the unique filters, read through the indirection table
+struct DedupOutput {
+    Tensor4D unique;
+    vector<int> channel_map;
+
+    const vector<vector<double>>& channel(int b, int oc) const { return unique[b][channel_map[oc]]; }
+
+    Tensor4D materialize() const {
+        Tensor4D output(unique.size(), vector<vector<vector<double>>>(channel_map.size()));
+        for (size_t b = 0; b < unique.size(); ++b)
+            for (size_t oc = 0; oc < channel_map.size(); ++oc) output[b][oc] = channel(b, oc);
+        return output;
+    }
+};
+
+// EXECUTE any conv on the unique filters only
+template <typename Conv>
+DedupOutput conv2d_dedup(Conv&& conv, const Tensor4D& input, const DedupKernel& kernel, int STRIDE, int PADDING) {
+    return { conv(input, kernel.unique, STRIDE, PADDING), kernel.channel_map };
+}
+
+void test(const DedupOutput& output, const Tensor4D& truth) {
+    for (size_t oc = 0; oc < truth[0].size(); ++oc) {
+        const vector<vector<double>>& channel = output.channel(0, oc);
+        for (size_t oh = 0; oh < truth[0][oc].size(); ++oh)
+            for (size_t ow = 0; ow < truth[0][oc][oh].size(); ++ow) assert(channel[oh][ow] == truth[0][oc][oh][ow]);
+    }
+}
+
+// CLUSTERED kernel: every output channel takes one of `clusters` random centroids, 0 gives each channel its own
+Tensor4D make_kernel(int clusters, unsigned seed) {
+    srand(seed);
+    vector<vector<vector<double>>> zero(IN_CHANNELS, vector<vector<double>>(KERNEL_SIZE, vector<double>(KERNEL_SIZE)));
+    Tensor4D centroids(clusters ? clusters : OUT_CHANNELS, zero);
+    for (auto& c : centroids)
+        for (auto& plane : c)
+            for (auto& row : plane)
+                for (double& v : row) v = round(16.0 * rand() / (RAND_MAX + 1.0)) / 16;
+    Tensor4D kernel(OUT_CHANNELS);
+    for (size_t oc = 0; oc < OUT_CHANNELS; ++oc) kernel[oc] = centroids[clusters ? rand() % clusters : oc];
+    return kernel;
+}
+
+int main() {
+    string filename = "pointcloud.csv";
+    init(filename, HEIGHT, WIDTH);
+
+    struct Case { string name; Tensor4D kernel; };
+    vector<Case> cases;
+    // INITIALIZE kernel by filling 0.5, the kernel of 0sparse / 1im2col / 2conv
+    cases.push_back({ "lab kernel (all 0.5)", Tensor4D(OUT_CHANNELS, vector<vector<vector<double>>>(IN_CHANNELS, vector<vector<double>>(KERNEL_SIZE, vector<double>(KERNEL_SIZE, 0.5)))) });
+    cases.push_back({ "clustered (16)      ", make_kernel(16, 5743) });
+    cases.push_back({ "random per channel  ", make_kernel(0, 5743) });
+
+    struct Path { string name; Tensor4D (*conv)(const Tensor4D&, const Tensor4D&, int, int); };
+    const Path paths[] = { { "direct", conv2d }, { "im2col", conv2d_im2col }, { "sparse", conv2d_sparse } };
+
+    cout << endl;
+    cout << "===== FILTER DEDUP OUT_CHANNELS = " << OUT_CHANNELS << " =====" << endl;
+    for (const Case& c : cases) {
+        auto t = get_time();
+        DedupKernel dedup = dedup_filters(c.kernel);
+        double prepare_time = get_time() - t;
+        cout << c.name << "\tunique filters: " << dedup.unique.size() << "/" << OUT_CHANNELS << "\tprepare: " << prepare_time << "s" << endl;
+
+        for (const Path& path : paths) {
+            Tensor4D truth = path.conv(input, c.kernel, STRIDE, PADDING);
+            test(conv2d_dedup(path.conv, input, dedup, STRIDE, PADDING), truth);
+            truth.clear();
+
+            double full_time = 0.0, dedup_time = 0.0, materialize_time = 0.0;
+            for (int iter = 0; iter < iterations; iter++) {
+                t = get_time();
+                Tensor4D output = path.conv(input, c.kernel, STRIDE, PADDING);
+                full_time += get_time() - t;
+                output.clear();
+
+                t = get_time();
+                DedupOutput shared = conv2d_dedup(path.conv, input, dedup, STRIDE, PADDING);
+                dedup_time += get_time() - t;
+
+                t = get_time();
+                Tensor4D materialized = shared.materialize();
+                materialize_time += get_time() - t;
+            }
+            cout << "###@@@ Avg Time for Calculation(" << path.name << "): full " << full_time / iterations << "s, dedup " << dedup_time / iterations
+                 << "s (+" << materialize_time / iterations << "s to materialize), speedup: " << full_time / dedup_time << "x." << endl;
+        }
+    }
+    cout << endl;
+
+    return 0;
+}
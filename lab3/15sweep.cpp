@@ -0,0 +1,329 @@
+#include <sys/time.h>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+/*
+ Shape sweep driver for the out-channel study. The point cloud is parsed once, then
+ for every (H, W, K) the sparse rulebook and the im2col matrix are prepared once and
+ reused by every OUT_CHANNELS value of the sweep. im2col and direct conv run on flat
+ [C, H, W] buffers with the loop structure of 1im2col / 2conv; the sparse method is a
+ scatter over a per-kernel-offset (input, output) rulebook, not the rulebook algorithm
+ of 0sparse.cpp (whose output-coordinate list is not reusable across OC). The table
+ goes out as CSV or JSON together with the OC values between which
+ two methods swap order.
+
+ Usage: ./15sweep [--oc=16,32,64] [--h=64] [--w=4096] [--k=3] [--iterations=2]
+                  [--format=csv|json] [--out=file]
+ H and W larger than the point cloud wrap around it, smaller ones crop it. Invalid
+ options (unknown format, iterations < 1, K larger than H or W, an output file that
+ cannot be opened) are rejected with exit code 1.
+*/
+
+// INITIALIZE paras
+const size_t CLOUD_HEIGHT = 64;
+const size_t CLOUD_WIDTH = 4096;
+size_t STRIDE = 1;
+size_t PADDING = 0;
+
+double get_time() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+vector<double> init(const string& filename, size_t rows, size_t cols) {
+    vector<double> cloud(rows * cols, 0.0);
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Failed to open file: " << filename << endl;
+        return cloud;
+    }
+
+    string line;
+    size_t row = 0;
+
+    while (getline(file, line)) { // split the data by line
+        if (row >= rows) break;
+        stringstream ss(line);
+        string value;
+        size_t col = 0;
+
+        while (getline(ss, value, ',')) { // split each line by ","
+            if (col >= cols) break;
+            cloud[row * cols + col] = round(stod(value));
+            col++;
+        }
+        row++;
+    }
+
+    file.close();
+    return cloud;
+}
+
+// Everything that depends on (H, W, K) but not on OUT_CHANNELS
+struct PreparedShape {
+    int height, width, K, out_height, out_width, pixels, col_width;
+    vector<double> input;        // [H, W]
+    vector<double> im2col;       // [pixels, K*K]
+    vector<int> rule_in, rule_out; // sparse rulebook, grouped by kernel offset
+    vector<int> rule_ptr;        // offset k owns rules [rule_ptr[k], rule_ptr[k + 1])
+    int nonzeros = 0;
+};
+
+PreparedShape prepare_shape(const vector<double>& cloud, int height, int width, int K) {
+    PreparedShape s;
+    s.height = height;
+    s.width = width;
+    s.K = K;
+    s.out_height = (height - K + 2 * PADDING) / STRIDE + 1;
+    s.out_width = (width - K + 2 * PADDING) / STRIDE + 1;
+    s.pixels = s.out_height * s.out_width;
+    s.col_width = K * K;
+
+    s.input.resize(size_t(height) * width);
+    for (int h = 0; h < height; ++h)
+        for (int w = 0; w < width; ++w) s.input[size_t(h) * width + w] = cloud[(h % CLOUD_HEIGHT) * CLOUD_WIDTH + w % CLOUD_WIDTH];
+
+    // IM2COL matrix, shared by every OC of this shape
+    s.im2col.assign(size_t(s.pixels) * s.col_width, 0.0);
+    for (int oh = 0; oh < s.out_height; ++oh)
+        for (int ow = 0; ow < s.out_width; ++ow)
+            for (int kh = 0; kh < K; ++kh)
+                for (int kw = 0; kw < K; ++kw) {
+                    int h_offset = oh * STRIDE + kh - PADDING;
+                    int w_offset = ow * STRIDE + kw - PADDING;
+                    if (h_offset >= 0 && h_offset < height && w_offset >= 0 && w_offset < width)
+                        s.im2col[(size_t(oh) * s.out_width + ow) * s.col_width + kh * K + kw] = s.input[size_t(h_offset) * width + w_offset];
+                }
+
+    // RULEBOOK: (nonzero input, output pixel) pairs per kernel offset
+    vector<int> nz;
+    for (int i = 0; i < height * width; ++i)
+        if (s.input[i] != 0.0) nz.push_back(i);
+    s.nonzeros = nz.size();
+    s.rule_ptr.push_back(0);
+    for (int kh = 0; kh < K; ++kh)
+        for (int kw = 0; kw < K; ++kw) {
+            for (int i : nz) {
+                int oh = i / width + PADDING - kh, ow = i % width + PADDING - kw;
+                if (oh < 0 || ow < 0 || oh % STRIDE || ow % STRIDE) continue;
+                oh /= STRIDE;
+                ow /= STRIDE;
+                if (oh >= s.out_height || ow >= s.out_width) continue;
+                s.rule_in.push_back(i);
+                s.rule_out.push_back(oh * s.out_width + ow);
+            }
+            s.rule_ptr.push_back(s.rule_in.size());
+        }
+    return s;
+}
+
+// SPARSE conv: scatter every rule into all output channels, output [OC, pixels]
+void sparse_conv(const PreparedShape& s, const vector<double>& kernel, int oc_count, vector<double>& out) {
+    out.assign(size_t(oc_count) * s.pixels, 0.0);
+    for (int k = 0; k < s.col_width; ++k)
+        for (int r = s.rule_ptr[k]; r < s.rule_ptr[k + 1]; ++r) {
+            double v = s.input[s.rule_in[r]];
+            int p = s.rule_out[r];
+            for (int oc = 0; oc < oc_count; ++oc) out[size_t(oc) * s.pixels + p] += v * kernel[oc * s.col_width + k];
+        }
+}
+
+// IM2COL conv: [pixels x KK] x [KK x OC] on the prepared matrix, output [OC, pixels]
+void im2col_conv(const PreparedShape& s, const vector<double>& kernel, int oc_count, vector<double>& out) {
+    out.assign(size_t(oc_count) * s.pixels, 0.0);
+    for (int p = 0; p < s.pixels; ++p) {
+        const double* col = &s.im2col[size_t(p) * s.col_width];
+        for (int oc = 0; oc < oc_count; ++oc) {
+            const double* k = &kernel[oc * s.col_width];
+            double sum = 0.0;
+            for (int i = 0; i < s.col_width; ++i) sum += col[i] * k[i];
+            out[size_t(oc) * s.pixels + p] = sum;
+        }
+    }
+}
+
+// DIRECT conv, loop order of 2conv.cpp, output [OC, pixels]
+void direct_conv(const PreparedShape& s, const vector<double>& kernel, int oc_count, vector<double>& out) {
+    out.assign(size_t(oc_count) * s.pixels, 0.0);
+    for (int oc = 0; oc < oc_count; ++oc)
+        for (int oh = 0; oh < s.out_height; ++oh)
+            for (int ow = 0; ow < s.out_width; ++ow) {
+                double sum = 0.0;
+                for (int kh = 0; kh < s.K; ++kh)
+                    for (int kw = 0; kw < s.K; ++kw) {
+                        int h_offset = oh * STRIDE + kh - PADDING;
+                        int w_offset = ow * STRIDE + kw - PADDING;
+                        if (h_offset >= 0 && h_offset < s.height && w_offset >= 0 && w_offset < s.width)
+                            sum += s.input[size_t(h_offset) * s.width + w_offset] * kernel[(oc * s.K + kh) * s.K + kw];
+                    }
+                out[size_t(oc) * s.pixels + size_t(oh) * s.out_width + ow] = sum;
+            }
+}
+
+struct Row {
+    int height, width, K, out_channels, nonzeros;
+    double sparse, im2col, direct;
+    string fastest() const {
+        if (sparse <= im2col && sparse <= direct) return "sparse";
+        return im2col <= direct ? "im2col" : "direct";
+    }
+};
+
+vector<int> parse_list(const string& text) {
+    vector<int> values;
+    stringstream ss(text);
+    string item;
+    while (getline(ss, item, ',')) {
+        size_t used = 0;
+        int v = stoi(item, &used);
+        if (used != item.size() || v < 1) throw invalid_argument("'" + item + "' is not a positive integer");
+        values.push_back(v);
+    }
+    if (values.empty()) throw invalid_argument("empty list");
+    return values;
+}
+
+int main(int argc, char** argv) {
+    vector<int> oc_list = { 16, 32, 64, 128, 256 }, h_list = { int(CLOUD_HEIGHT) }, w_list = { int(CLOUD_WIDTH) }, k_list = { 3 };
+    int iterations = 2;
+    string format = "csv", out_file;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        size_t eq = arg.find('=');
+        string key = arg.substr(0, eq), value = eq == string::npos ? "" : arg.substr(eq + 1);
+        try {
+            if (key == "--oc") oc_list = parse_list(value);
+            else if (key == "--h") h_list = parse_list(value);
+            else if (key == "--w") w_list = parse_list(value);
+            else if (key == "--k") k_list = parse_list(value);
+            else if (key == "--iterations") {
+                vector<int> values = parse_list(value);
+                if (values.size() != 1) throw invalid_argument("expected a single value");
+                iterations = values[0];
+            }
+            else if (key == "--format") format = value;
+            else if (key == "--out") out_file = value;
+            else {
+                cerr << "Unknown option: " << arg << endl;
+                return 1;
+            }
+        } catch (const exception& e) {
+            cerr << "Invalid value in " << arg << ": " << e.what() << endl;
+            return 1;
+        }
+    }
+    sort(oc_list.begin(), oc_list.end());
+
+    // VALIDATE before any work: the sweep averages over iterations and sizes the output from H - K, W - K
+    if (format != "csv" && format != "json") {
+        cerr << "Unknown format: " << format << " (csv or json)" << endl;
+        return 1;
+    }
+    if (iterations < 1) {
+        cerr << "--iterations must be at least 1" << endl;
+        return 1;
+    }
+    for (int K : k_list)
+        for (int height : h_list)
+            for (int width : w_list)
+                if (K > height + 2 * int(PADDING) || K > width + 2 * int(PADDING)) {
+                    cerr << "K=" << K << " does not fit H=" << height << " W=" << width << endl;
+                    return 1;
+                }
+    ofstream file;
+    if (!out_file.empty()) {
+        file.open(out_file);
+        if (!file.is_open()) {
+            cerr << "Failed to open file: " << out_file << endl;
+            return 1;
+        }
+    }
+
+    // LOAD the point cloud once for the whole sweep
+    auto t = get_time();
+    vector<double> cloud = init("pointcloud.csv", CLOUD_HEIGHT, CLOUD_WIDTH);
+    cerr << "Loaded pointcloud.csv in " << get_time() - t << "s" << endl;
+
+    vector<Row> rows;
+    vector<string> crossovers;
+    for (int height : h_list)
+        for (int width : w_list)
+            for (int K : k_list) {
+                t = get_time();
+                PreparedShape shape = prepare_shape(cloud, height, width, K);
+                cerr << "Prepared H=" << height << " W=" << width << " K=" << K << " in " << get_time() - t << "s" << endl;
+
+                for (int oc : oc_list) {
+                    vector<double> kernel(size_t(oc) * K * K, 0.5);
+                    vector<double> out_sparse, out_im2col, out_direct;
+                    Row row = { height, width, K, oc, shape.nonzeros, 0.0, 0.0, 0.0 };
+                    for (int iter = 0; iter < iterations; iter++) {
+                        t = get_time();
+                        sparse_conv(shape, kernel, oc, out_sparse);
+                        row.sparse += get_time() - t;
+                        t = get_time();
+                        im2col_conv(shape, kernel, oc, out_im2col);
+                        row.im2col += get_time() - t;
+                        t = get_time();
+                        direct_conv(shape, kernel, oc, out_direct);
+                        row.direct += get_time() - t;
+                    }
+                    // CHECK the three methods agree
+                    for (size_t i = 0; i < out_direct.size(); ++i)
+                        assert(fabs(out_sparse[i] - out_direct[i]) < 1e-9 && fabs(out_im2col[i] - out_direct[i]) < 1e-9);
+                    row.sparse /= iterations;
+                    row.im2col /= iterations;
+                    row.direct /= iterations;
+                    cerr << "  OC=" << oc << "\tsparse: " << row.sparse << "s\tim2col: " << row.im2col << "s\tdirect: " << row.direct << "s" << endl;
+
+                    // CROSSOVER: two methods swap order between the previous OC of the same shape and this one
+                    if (!rows.empty() && rows.back().height == height && rows.back().width == width && rows.back().K == K) {
+                        const Row& prev = rows.back();
+                        const char* names[3] = { "sparse", "im2col", "direct" };
+                        double before[3] = { prev.sparse, prev.im2col, prev.direct }, after[3] = { row.sparse, row.im2col, row.direct };
+                        for (int a = 0; a < 3; ++a)
+                            for (int b = a + 1; b < 3; ++b) {
+                                if ((before[a] < before[b]) == (after[a] < after[b])) continue;
+                                stringstream ss;
+                                ss << "H=" << height << " W=" << width << " K=" << K << ": " << (after[a] < after[b] ? names[a] : names[b])
+                                   << " overtakes " << (after[a] < after[b] ? names[b] : names[a]) << " between OC=" << prev.out_channels << " and OC=" << oc;
+                                crossovers.push_back(ss.str());
+                            }
+                    }
+                    rows.push_back(row);
+                }
+            }
+
+    ostream& out = out_file.empty() ? cout : file;
+    if (format == "json") {
+        out << "{\n  \"rows\": [\n";
+        for (size_t i = 0; i < rows.size(); ++i) {
+            const Row& r = rows[i];
+            out << "    {\"height\": " << r.height << ", \"width\": " << r.width << ", \"kernel_size\": " << r.K << ", \"out_channels\": " << r.out_channels
+                << ", \"nonzeros\": " << r.nonzeros << ", \"sparse\": " << r.sparse << ", \"im2col\": " << r.im2col << ", \"direct\": " << r.direct
+                << ", \"fastest\": \"" << r.fastest() << "\"}" << (i + 1 < rows.size() ? "," : "") << "\n";
+        }
+        out << "  ],\n  \"crossovers\": [";
+        for (size_t i = 0; i < crossovers.size(); ++i) out << (i ? ", " : "") << "\"" << crossovers[i] << "\"";
+        out << "]\n}" << endl;
+    } else {
+        out << "height,width,kernel_size,out_channels,nonzeros,sparse_s,im2col_s,direct_s,fastest" << endl;
+        for (const Row& r : rows)
+            out << r.height << "," << r.width << "," << r.K << "," << r.out_channels << "," << r.nonzeros << ","
+                << r.sparse << "," << r.im2col << "," << r.direct << "," << r.fastest() << endl;
+        for (const string& c : crossovers) out << "# crossover: " << c << endl;
+        if (crossovers.empty()) out << "# crossover: none, the methods keep their order over the whole sweep" << endl;
+    }
+
+    return 0;
+}
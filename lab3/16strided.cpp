@@ -0,0 +1,288 @@
+#include <sys/time.h>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include <cassert>
+
+using namespace std;
+
+/*
+ Strided sparse convolution and sparse max / avg pooling. A stride-S layer does not
+ reuse its input sites: the output coordinate set is the input set downsampled by
+ hashing floor(h / S), floor(w / S), and a rulebook for that level maps every
+ (input site, output site) pair to its kernel offset. Features stay [n x C], the
+ weights are [K*K][C_in][C_out] so each rule is one small gather-GEMM-scatter.
+
+ Pooling treats missing sites as absent, not as zeros: max is over the active inputs
+ of the window and avg divides by their count.
+*/
+
+// INITIALIZE paras
+size_t HEIGHT = 64;
+size_t WIDTH = 4096;
+int iterations = 8;
+
+double get_time() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+vector<double> init(const string& filename, size_t rows, size_t cols) {
+    vector<double> cloud(rows * cols, 0.0);
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Failed to open file: " << filename << endl;
+        return cloud;
+    }
+
+    string line;
+    size_t row = 0;
+
+    while (getline(file, line)) { // split the data by line
+        if (row >= rows) break;
+        stringstream ss(line);
+        string value;
+        size_t col = 0;
+
+        while (getline(ss, value, ',')) { // split each line by ","
+            if (col >= cols) break;
+            cloud[row * cols + col] = round(stod(value));
+            col++;
+        }
+        row++;
+    }
+
+    file.close();
+    return cloud;
+}
+
+struct Coord {
+    int h, w;
+};
+
+inline long long coord_key(int h, int w) { return (static_cast<long long>(h) << 32) | static_cast<unsigned>(w); }
+
+// Active sites of one resolution level, features[i * channels + c] belongs to coords[i]
+struct SparseTensor {
+    int height = 0, width = 0, channels = 0;
+    vector<Coord> coords;
+    vector<double> features;
+    size_t size() const { return coords.size(); }
+};
+
+// Kernel map of one layer: rules of offset k are (in_idx[k][j], out_idx[k][j])
+struct Rulebook {
+    int K = 0, S = 1, P = 0;
+    vector<vector<int>> in_idx, out_idx;
+    size_t rules() const {
+        size_t n = 0;
+        for (const auto& r : in_idx) n += r.size();
+        return n;
+    }
+};
+
+SparseTensor from_dense(const vector<double>& dense, int height, int width) {
+    SparseTensor t;
+    t.height = height;
+    t.width = width;
+    t.channels = 1;
+    for (int h = 0; h < height; ++h)
+        for (int w = 0; w < width; ++w)
+            if (dense[size_t(h) * width + w] != 0.0) {
+                t.coords.push_back({ h, w });
+                t.features.push_back(dense[size_t(h) * width + w]);
+            }
+    return t;
+}
+
+// DOWNSAMPLE a coordinate set by hashing floor(coord / S), first-seen order
+vector<Coord> downsample_coords(const vector<Coord>& in, int S, int out_height, int out_width) {
+    unordered_map<long long, int> seen;
+    seen.reserve(in.size());
+    vector<Coord> out;
+    for (const Coord& c : in) {
+        int h = c.h / S, w = c.w / S;
+        if (h >= out_height || w >= out_width) continue;
+        if (seen.emplace(coord_key(h, w), out.size()).second) out.push_back({ h, w });
+    }
+    return out;
+}
+
+// BUILD the rulebook: output o reads input o * S + k - P for every offset k that is active
+Rulebook build_rulebook(const vector<Coord>& in, const vector<Coord>& out, int K, int S, int P) {
+    unordered_map<long long, int> in_index;
+    in_index.reserve(in.size());
+    for (size_t i = 0; i < in.size(); ++i) in_index.emplace(coord_key(in[i].h, in[i].w), i);
+
+    Rulebook rb;
+    rb.K = K;
+    rb.S = S;
+    rb.P = P;
+    rb.in_idx.assign(K * K, vector<int>());
+    rb.out_idx.assign(K * K, vector<int>());
+    for (size_t o = 0; o < out.size(); ++o)
+        for (int kh = 0; kh < K; ++kh)
+            for (int kw = 0; kw < K; ++kw) {
+                auto it = in_index.find(coord_key(out[o].h * S + kh - P, out[o].w * S + kw - P));
+                if (it == in_index.end()) continue;
+                rb.in_idx[kh * K + kw].push_back(it->second);
+                rb.out_idx[kh * K + kw].push_back(o);
+            }
+    return rb;
+}
+
+// EXECUTE strided sparse conv over a prepared rulebook, weights [K*K][C_in][C_out]
+SparseTensor sparse_conv(const SparseTensor& in, const Rulebook& rb, const vector<Coord>& out_coords,
+                         int out_height, int out_width, const vector<double>& weights, int out_channels) {
+    SparseTensor out;
+    out.height = out_height;
+    out.width = out_width;
+    out.channels = out_channels;
+    out.coords = out_coords;
+    out.features.assign(out_coords.size() * out_channels, 0.0);
+    int in_channels = in.channels;
+    for (int k = 0; k < rb.K * rb.K; ++k) {
+        const double* w = &weights[size_t(k) * in_channels * out_channels];
+        for (size_t j = 0; j < rb.in_idx[k].size(); ++j) {
+            const double* src = &in.features[size_t(rb.in_idx[k][j]) * in_channels];
+            double* dst = &out.features[size_t(rb.out_idx[k][j]) * out_channels];
+            for (int ic = 0; ic < in_channels; ++ic)
+                for (int oc = 0; oc < out_channels; ++oc) dst[oc] += src[ic] * w[ic * out_channels + oc];
+        }
+    }
+    return out;
+}
+
+enum PoolMode { MAX_POOL, AVG_POOL };
+
+// EXECUTE sparse pooling over a prepared rulebook, channels are unchanged
+SparseTensor sparse_pool(const SparseTensor& in, const Rulebook& rb, const vector<Coord>& out_coords,
+                         int out_height, int out_width, PoolMode mode) {
+    SparseTensor out;
+    out.height = out_height;
+    out.width = out_width;
+    out.channels = in.channels;
+    out.coords = out_coords;
+    int C = in.channels;
+    out.features.assign(out_coords.size() * C, mode == MAX_POOL ? -HUGE_VAL : 0.0);
+    vector<int> count(out_coords.size(), 0);
+    for (int k = 0; k < rb.K * rb.K; ++k)
+        for (size_t j = 0; j < rb.in_idx[k].size(); ++j) {
+            const double* src = &in.features[size_t(rb.in_idx[k][j]) * C];
+            double* dst = &out.features[size_t(rb.out_idx[k][j]) * C];
+            ++count[rb.out_idx[k][j]];
+            for (int c = 0; c < C; ++c) dst[c] = mode == MAX_POOL ? max(dst[c], src[c]) : dst[c] + src[c];
+        }
+    for (size_t o = 0; o < out_coords.size(); ++o)
+        for (int c = 0; c < C; ++c) {
+            double& v = out.features[o * C + c];
+            if (count[o] == 0) v = 0.0;
+            else if (mode == AVG_POOL) v /= count[o];
+        }
+    return out;
+}
+
+// DENSE references on [C][H][W] grids, used to check the sparse layers
+vector<double> densify(const SparseTensor& t) {
+    vector<double> dense(size_t(t.channels) * t.height * t.width, 0.0);
+    for (size_t i = 0; i < t.size(); ++i)
+        for (int c = 0; c < t.channels; ++c)
+            dense[(size_t(c) * t.height + t.coords[i].h) * t.width + t.coords[i].w] = t.features[i * t.channels + c];
+    return dense;
+}
+
+// One dense output value of conv (weights != nullptr) or of a pool over the active mask
+double dense_window(const vector<double>& dense, const vector<double>& mask, int C, int height, int width,
+                    int oh, int ow, int K, int S, int P, int oc, const vector<double>* weights, int out_channels, PoolMode mode) {
+    double acc = weights || mode == AVG_POOL ? 0.0 : -HUGE_VAL;
+    int count = 0;
+    for (int kh = 0; kh < K; ++kh)
+        for (int kw = 0; kw < K; ++kw) {
+            int h = oh * S + kh - P, w = ow * S + kw - P;
+            if (h < 0 || h >= height || w < 0 || w >= width || mask[size_t(h) * width + w] == 0.0) continue;
+            ++count;
+            if (weights) {
+                for (int ic = 0; ic < C; ++ic)
+                    acc += dense[(size_t(ic) * height + h) * width + w] * (*weights)[(size_t(kh * K + kw) * C + ic) * out_channels + oc];
+            } else {
+                double v = dense[(size_t(oc) * height + h) * width + w];
+                acc = mode == MAX_POOL ? max(acc, v) : acc + v;
+            }
+        }
+    if (!weights && count == 0) return 0.0;
+    return !weights && mode == AVG_POOL ? acc / count : acc;
+}
+
+struct Level {
+    string name;
+    bool conv; // false: pooling
+    PoolMode mode;
+    int out_channels, K, S, P;
+};
+
+int main() {
+    string filename = "pointcloud.csv";
+    vector<double> cloud = init(filename, HEIGHT, WIDTH);
+
+    // A downsampling backbone, every level halves the resolution
+    vector<Level> levels = {
+        // name           conv   pool      OC  K  S  P
+        { "conv1 s2",     true,  MAX_POOL, 16, 3, 2, 1 },
+        { "conv2 s2",     true,  MAX_POOL, 32, 3, 2, 1 },
+        { "maxpool s2",   false, MAX_POOL,  0, 2, 2, 0 },
+        { "conv3 s2",     true,  MAX_POOL, 64, 3, 2, 1 },
+        { "avgpool s2",   false, AVG_POOL,  0, 2, 2, 0 },
+    };
+
+    cout << endl;
+    cout << "===== STRIDED SPARSE CONV / POOL (" << levels.size() << " levels) =====" << endl;
+    SparseTensor x = from_dense(cloud, HEIGHT, WIDTH);
+    cout << "input\t\t[" << x.channels << ", " << x.height << ", " << x.width << "]\tactive sites: " << x.size() << endl;
+    for (const Level& l : levels) {
+        int out_height = (x.height - l.K + 2 * l.P) / l.S + 1;
+        int out_width = (x.width - l.K + 2 * l.P) / l.S + 1;
+        int out_channels = l.conv ? l.out_channels : x.channels;
+        vector<double> weights;
+        if (l.conv) {
+            weights.resize(size_t(l.K) * l.K * x.channels * out_channels);
+            for (size_t i = 0; i < weights.size(); ++i) weights[i] = 0.5 / x.channels * (1 + i % 3);
+        }
+
+        // PREPARE the coordinate set and rulebook of this level, then time the feature pass alone
+        double build_time = 0.0, compute_time = 0.0;
+        vector<Coord> out_coords;
+        Rulebook rb;
+        SparseTensor y;
+        for (int iter = 0; iter < iterations; iter++) {
+            auto t = get_time();
+            out_coords = downsample_coords(x.coords, l.S, out_height, out_width);
+            rb = build_rulebook(x.coords, out_coords, l.K, l.S, l.P);
+            build_time += get_time() - t;
+
+            t = get_time();
+            y = l.conv ? sparse_conv(x, rb, out_coords, out_height, out_width, weights, out_channels)
+                       : sparse_pool(x, rb, out_coords, out_height, out_width, l.mode);
+            compute_time += get_time() - t;
+        }
+
+        // CHECK every output site against the dense computation over the active input mask
+        vector<double> dense = densify(x), mask(size_t(x.height) * x.width, 0.0);
+        for (const Coord& c : x.coords) mask[size_t(c.h) * x.width + c.w] = 1.0;
+        for (size_t o = 0; o < y.size(); ++o)
+            for (int oc = 0; oc < out_channels; ++oc)
+                assert(fabs(y.features[o * out_channels + oc] - dense_window(dense, mask, x.channels, x.height, x.width, y.coords[o].h, y.coords[o].w,
+                                                                           l.K, l.S, l.P, oc, l.conv ? &weights : nullptr, out_channels, l.mode)) < 1e-9);
+
+        cout << l.name << "\t[" << y.channels << ", " << y.height << ", " << y.width << "]\tactive sites: " << x.size() << " -> " << y.size()
+             << "\trules: " << rb.rules() << "\tbuild: " << build_time / iterations << "s\tcompute: " << compute_time / iterations << "s" << endl;
+        x = y;
+    }
+    cout << endl;
+
+    return 0;
+}
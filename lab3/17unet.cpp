@@ -0,0 +1,420 @@
+#include <sys/time.h>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <array>
+#include <map>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include <cassert>
+
+using namespace std;
+
+/*
+ Sparse transposed convolution and a U-Net pass over the point cloud. The kernel
+ maps of 16strided.cpp go into a KernelMapCache keyed by (coordinate-set id, K, S, P):
+ an encoder layer looks its map up by the id of its fine input, and the matching
+ decoder layer, which upsamples back onto that same fine set, asks for the same key
+ and runs the rulebook with input and output indices swapped. No coordinate is hashed
+ twice within a pass, and a second pass over the same cloud hashes nothing.
+
+ Submanifold layers (stride 1, padding K / 2 * dilation) keep their input coordinate
+ set and its id, so a stack of them at one resolution resolves to a single cache key
+ per (K, dilation) and shares one rulebook build.
+*/
+
+// INITIALIZE paras
+size_t HEIGHT = 64;
+size_t WIDTH = 4096;
+int iterations = 32;
+
+double get_time() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+vector<double> init(const string& filename, size_t rows, size_t cols) {
+    vector<double> cloud(rows * cols, 0.0);
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Failed to open file: " << filename << endl;
+        return cloud;
+    }
+
+    string line;
+    size_t row = 0;
+
+    while (getline(file, line)) { // split the data by line
+        if (row >= rows) break;
+        stringstream ss(line);
+        string value;
+        size_t col = 0;
+
+        while (getline(ss, value, ',')) { // split each line by ","
+            if (col >= cols) break;
+            cloud[row * cols + col] = round(stod(value));
+            col++;
+        }
+        row++;
+    }
+
+    file.close();
+    return cloud;
+}
+
+struct Coord {
+    int h, w;
+};
+
+inline long long coord_key(int h, int w) { return (static_cast<long long>(h) << 32) | static_cast<unsigned>(w); }
+
+// Active sites of one resolution level, coord_id names the coordinate set for the kernel-map cache
+struct SparseTensor {
+    int height = 0, width = 0, channels = 0;
+    int coord_id = -1;
+    vector<Coord> coords;
+    vector<double> features;
+    size_t size() const { return coords.size(); }
+};
+
+// Kernel map of one layer: rules of offset k are (in_idx[k][j], out_idx[k][j])
+struct Rulebook {
+    int K = 0, S = 1, P = 0;
+    vector<vector<int>> in_idx, out_idx;
+    size_t rules() const {
+        size_t n = 0;
+        for (const auto& r : in_idx) n += r.size();
+        return n;
+    }
+};
+
+// DOWNSAMPLE a coordinate set by hashing floor(coord / S), first-seen order
+vector<Coord> downsample_coords(const vector<Coord>& in, int S, int out_height, int out_width) {
+    unordered_map<long long, int> seen;
+    seen.reserve(in.size());
+    vector<Coord> out;
+    for (const Coord& c : in) {
+        int h = c.h / S, w = c.w / S;
+        if (h >= out_height || w >= out_width) continue;
+        if (seen.emplace(coord_key(h, w), out.size()).second) out.push_back({ h, w });
+    }
+    return out;
+}
+
+// BUILD the rulebook: output o reads input o * S + k * D - P for every offset k that is active
+Rulebook build_rulebook(const vector<Coord>& in, const vector<Coord>& out, int K, int S, int P, int D) {
+    unordered_map<long long, int> in_index;
+    in_index.reserve(in.size());
+    for (size_t i = 0; i < in.size(); ++i) in_index.emplace(coord_key(in[i].h, in[i].w), i);
+
+    Rulebook rb;
+    rb.K = K;
+    rb.S = S;
+    rb.P = P;
+    rb.in_idx.assign(K * K, vector<int>());
+    rb.out_idx.assign(K * K, vector<int>());
+    for (size_t o = 0; o < out.size(); ++o)
+        for (int kh = 0; kh < K; ++kh)
+            for (int kw = 0; kw < K; ++kw) {
+                auto it = in_index.find(coord_key(out[o].h * S + kh * D - P, out[o].w * S + kw * D - P));
+                if (it == in_index.end()) continue;
+                rb.in_idx[kh * K + kw].push_back(it->second);
+                rb.out_idx[kh * K + kw].push_back(o);
+            }
+    return rb;
+}
+
+// Output coordinate set of one layer and its rulebook
+struct KernelMap {
+    int out_coord_id;
+    int out_height, out_width;
+    vector<Coord> out_coords;
+    Rulebook rb;
+};
+
+// CACHE of kernel maps keyed by (coordinate-set id, K, S, P, dilation)
+struct KernelMapCache {
+    map<array<int, 5>, KernelMap> maps;
+    int next_id = 0;
+    size_t hits = 0, misses = 0;
+    double build_time = 0.0;
+
+    int new_coord_id() { return next_id++; }
+
+    const KernelMap& get(const SparseTensor& in, int K, int S, int P, int D = 1) {
+        array<int, 5> key = { in.coord_id, K, S, P, D };
+        auto it = maps.find(key);
+        if (it != maps.end()) {
+            ++hits;
+            return it->second;
+        }
+        ++misses;
+        auto t = get_time();
+        KernelMap km;
+        km.out_height = (in.height - (K - 1) * D - 1 + 2 * P) / S + 1;
+        km.out_width = (in.width - (K - 1) * D - 1 + 2 * P) / S + 1;
+        if (S == 1 && km.out_height == in.height && km.out_width == in.width) {
+            // SUBMANIFOLD: the output sites are the input sites, under the same id
+            km.out_coords = in.coords;
+            km.out_coord_id = in.coord_id;
+        } else {
+            km.out_coords = downsample_coords(in.coords, S, km.out_height, km.out_width);
+            km.out_coord_id = new_coord_id();
+        }
+        km.rb = build_rulebook(in.coords, km.out_coords, K, S, P, D);
+        build_time += get_time() - t;
+        return maps.emplace(key, km).first->second;
+    }
+
+    void clear() {
+        maps.clear();
+        hits = misses = 0;
+        build_time = 0.0;
+    }
+};
+
+SparseTensor from_dense(const vector<double>& dense, int height, int width, KernelMapCache& cache) {
+    SparseTensor t;
+    t.height = height;
+    t.width = width;
+    t.channels = 1;
+    t.coord_id = cache.new_coord_id();
+    for (int h = 0; h < height; ++h)
+        for (int w = 0; w < width; ++w)
+            if (dense[size_t(h) * width + w] != 0.0) {
+                t.coords.push_back({ h, w });
+                t.features.push_back(dense[size_t(h) * width + w]);
+            }
+    return t;
+}
+
+// EXECUTE strided sparse conv, fine -> coarse, weights [K*K][C_in][C_out]
+SparseTensor sparse_conv(const SparseTensor& in, const KernelMap& km, const vector<double>& weights, int out_channels) {
+    SparseTensor out;
+    out.height = km.out_height;
+    out.width = km.out_width;
+    out.channels = out_channels;
+    out.coord_id = km.out_coord_id;
+    out.coords = km.out_coords;
+    out.features.assign(out.coords.size() * out_channels, 0.0);
+    int in_channels = in.channels;
+    for (int k = 0; k < km.rb.K * km.rb.K; ++k) {
+        const double* w = &weights[size_t(k) * in_channels * out_channels];
+        for (size_t j = 0; j < km.rb.in_idx[k].size(); ++j) {
+            const double* src = &in.features[size_t(km.rb.in_idx[k][j]) * in_channels];
+            double* dst = &out.features[size_t(km.rb.out_idx[k][j]) * out_channels];
+            for (int ic = 0; ic < in_channels; ++ic)
+                for (int oc = 0; oc < out_channels; ++oc) dst[oc] += src[ic] * w[ic * out_channels + oc];
+        }
+    }
+    return out;
+}
+
+// EXECUTE sparse transposed conv, coarse -> fine, over the strided layer's map with in / out swapped.
+// `fine` only provides the target coordinate set, weights are [K*K][C_in][C_out]
+SparseTensor sparse_conv_transposed(const SparseTensor& coarse, const SparseTensor& fine, const KernelMap& km,
+                                    const vector<double>& weights, int out_channels) {
+    assert(coarse.coord_id == km.out_coord_id);
+    SparseTensor out;
+    out.height = fine.height;
+    out.width = fine.width;
+    out.channels = out_channels;
+    out.coord_id = fine.coord_id;
+    out.coords = fine.coords;
+    out.features.assign(out.coords.size() * out_channels, 0.0);
+    int in_channels = coarse.channels;
+    for (int k = 0; k < km.rb.K * km.rb.K; ++k) {
+        const double* w = &weights[size_t(k) * in_channels * out_channels];
+        for (size_t j = 0; j < km.rb.in_idx[k].size(); ++j) {
+            const double* src = &coarse.features[size_t(km.rb.out_idx[k][j]) * in_channels];
+            double* dst = &out.features[size_t(km.rb.in_idx[k][j]) * out_channels];
+            for (int ic = 0; ic < in_channels; ++ic)
+                for (int oc = 0; oc < out_channels; ++oc) dst[oc] += src[ic] * w[ic * out_channels + oc];
+        }
+    }
+    return out;
+}
+
+// ADD a skip connection, both tensors live on the same coordinate set
+void add_skip(SparseTensor& x, const SparseTensor& skip) {
+    assert(x.coord_id == skip.coord_id && x.channels == skip.channels);
+    for (size_t i = 0; i < x.features.size(); ++i) x.features[i] += skip.features[i];
+}
+
+void relu(SparseTensor& x) {
+    for (double& v : x.features) v = max(v, 0.0);
+}
+
+vector<double> make_weights(int K, int in_channels, int out_channels, unsigned seed) {
+    srand(seed);
+    vector<double> w(size_t(K) * K * in_channels * out_channels);
+    for (double& v : w) v = (rand() / (RAND_MAX + 1.0) - 0.25) / in_channels;
+    return w;
+}
+
+// TRANSPOSE weights [K*K][C_in][C_out] -> [K*K][C_out][C_in]
+vector<double> transpose_weights(const vector<double>& w, int K, int in_channels, int out_channels) {
+    vector<double> t(w.size());
+    for (int k = 0; k < K * K; ++k)
+        for (int ic = 0; ic < in_channels; ++ic)
+            for (int oc = 0; oc < out_channels; ++oc)
+                t[(size_t(k) * out_channels + oc) * in_channels + ic] = w[(size_t(k) * in_channels + ic) * out_channels + oc];
+    return t;
+}
+
+double dot(const vector<double>& a, const vector<double>& b) {
+    double s = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) s += a[i] * b[i];
+    return s;
+}
+
+// Encoder widths per level and the kernel shape of every strided / transposed pair
+const int LEVELS = 3;
+const int ENC_CHANNELS[LEVELS + 1] = { 1, 16, 32, 64 };
+const int OUT_CHANNELS = 8;
+const int K = 3, S = 2, P = 1;
+
+struct UNet {
+    vector<double> enc_w[LEVELS], dec_w[LEVELS];
+
+    UNet() {
+        for (int l = 0; l < LEVELS; ++l) {
+            enc_w[l] = make_weights(K, ENC_CHANNELS[l], ENC_CHANNELS[l + 1], 100 + l);
+            // decoder l maps level l + 1 back to level l, the top one ends in OUT_CHANNELS
+            dec_w[l] = make_weights(K, ENC_CHANNELS[l + 1], l == 0 ? OUT_CHANNELS : ENC_CHANNELS[l], 200 + l);
+        }
+    }
+
+    SparseTensor forward(const SparseTensor& input, KernelMapCache& cache) const {
+        SparseTensor enc[LEVELS + 1];
+        enc[0] = input;
+        for (int l = 0; l < LEVELS; ++l) {
+            enc[l + 1] = sparse_conv(enc[l], cache.get(enc[l], K, S, P), enc_w[l], ENC_CHANNELS[l + 1]);
+            relu(enc[l + 1]);
+        }
+        SparseTensor x = enc[LEVELS];
+        for (int l = LEVELS - 1; l >= 0; --l) {
+            // SAME key as the encoder layer that produced level l + 1, so this is a cache hit
+            x = sparse_conv_transposed(x, enc[l], cache.get(enc[l], K, S, P), dec_w[l], l == 0 ? OUT_CHANNELS : ENC_CHANNELS[l]);
+            if (l > 0) {
+                add_skip(x, enc[l]);
+                relu(x);
+            }
+        }
+        return x;
+    }
+};
+
+// A stack of submanifold layers at the input resolution, {K, dilation} per layer
+const int SUBM_CHANNELS = 16;
+const int SUBM_LAYERS[][2] = { {3, 1}, {3, 1}, {3, 1}, {3, 1}, {3, 2}, {3, 2}, {3, 1}, {3, 1} };
+
+SparseTensor submanifold_stack(const SparseTensor& input, const vector<vector<double>>& weights, KernelMapCache& cache, bool shared,
+                               double* build_time) {
+    SparseTensor x = input;
+    *build_time = 0.0;
+    for (size_t l = 0; l < weights.size(); ++l) {
+        int k = SUBM_LAYERS[l][0], d = SUBM_LAYERS[l][1];
+        if (!shared) { // every layer rebuilds its map, as 0sparse.cpp does per call
+            *build_time += cache.build_time;
+            cache.clear();
+        }
+        x = sparse_conv(x, cache.get(x, k, 1, k / 2 * d, d), weights[l], SUBM_CHANNELS);
+        relu(x);
+    }
+    *build_time += cache.build_time;
+    return x;
+}
+
+int main() {
+    string filename = "pointcloud.csv";
+    vector<double> cloud = init(filename, HEIGHT, WIDTH);
+    KernelMapCache cache;
+    SparseTensor input = from_dense(cloud, HEIGHT, WIDTH, cache);
+
+    // CHECK the transposed conv is the adjoint of the strided conv: <conv(x), y> == <x, conv_T(y)>
+    {
+        SparseTensor x = input;
+        x.channels = 4;
+        x.features.resize(x.size() * x.channels);
+        for (double& v : x.features) v = rand() / (RAND_MAX + 1.0);
+        const KernelMap& km = cache.get(x, K, S, P);
+        vector<double> w = make_weights(K, 4, 6, 1);
+        SparseTensor y = sparse_conv(x, km, w, 6);
+        for (double& v : y.features) v = rand() / (RAND_MAX + 1.0);
+        double lhs = dot(sparse_conv(x, km, w, 6).features, y.features);
+        double rhs = dot(x.features, sparse_conv_transposed(y, x, km, transpose_weights(w, K, 4, 6), 4).features);
+        assert(fabs(lhs - rhs) < 1e-9 * fabs(lhs));
+        cache.clear();
+    }
+
+    UNet net;
+    cout << endl;
+    cout << "===== SPARSE U-NET (" << LEVELS << " strided + " << LEVELS << " transposed layers) =====" << endl;
+
+    // COLD: every pass starts from an empty cache, so only the decoder reuses the encoder maps
+    double cold_time = 0.0, cold_build = 0.0;
+    SparseTensor reference;
+    for (int iter = 0; iter < iterations; iter++) {
+        cache.clear();
+        auto t = get_time();
+        reference = net.forward(input, cache);
+        cold_time += get_time() - t;
+        cold_build += cache.build_time;
+    }
+    cout << "cold cache\thits/misses per pass: " << cache.hits << "/" << cache.misses << "\tmap build: " << cold_build / iterations
+         << "s\tpass: " << cold_time / iterations << "s" << endl;
+
+    // WARM: the cache outlives the passes, the kernel maps are built once for the cloud
+    cache.clear();
+    double warm_time = 0.0;
+    for (int iter = 0; iter < iterations; iter++) {
+        auto t = get_time();
+        SparseTensor output = net.forward(input, cache);
+        warm_time += get_time() - t;
+        assert(output.coord_id == input.coord_id && output.features == reference.features);
+    }
+    cout << "warm cache\thits/misses over " << iterations << " passes: " << cache.hits << "/" << cache.misses << "\tmap build: "
+         << cache.build_time << "s total\tpass: " << warm_time / iterations << "s" << endl;
+    cout << "output [" << reference.channels << ", " << reference.height << ", " << reference.width << "] on the " << reference.size()
+         << " input sites" << endl;
+    cout << "###@@@ Avg Time for Calculation(U-Net pass, cold cache): " << cold_time / iterations << "s, (warm cache): " << warm_time / iterations
+         << "s, speedup: " << cold_time / warm_time << "x." << endl;
+    cout << endl;
+
+    // SUBMANIFOLD stack: one map build per (K, dilation) instead of one per layer
+    vector<vector<double>> subm_w;
+    for (size_t l = 0; l < sizeof(SUBM_LAYERS) / sizeof(SUBM_LAYERS[0]); ++l)
+        subm_w.push_back(make_weights(SUBM_LAYERS[l][0], l == 0 ? 1 : SUBM_CHANNELS, SUBM_CHANNELS, 300 + l));
+    cout << "===== SUBMANIFOLD STACK (" << subm_w.size() << " layers, " << SUBM_CHANNELS << " channels) =====" << endl;
+    double per_layer_time = 0.0, shared_time = 0.0, per_layer_build = 0.0, shared_build = 0.0;
+    size_t shared_hits = 0, shared_misses = 0;
+    for (int iter = 0; iter < iterations; iter++) {
+        double build = 0.0;
+        cache.clear();
+        auto t = get_time();
+        SparseTensor a = submanifold_stack(input, subm_w, cache, false, &build);
+        per_layer_time += get_time() - t;
+        per_layer_build += build;
+
+        cache.clear();
+        t = get_time();
+        SparseTensor b = submanifold_stack(input, subm_w, cache, true, &build);
+        shared_time += get_time() - t;
+        shared_build += build;
+        shared_hits = cache.hits;
+        shared_misses = cache.misses;
+        assert(a.features == b.features && b.coord_id == input.coord_id);
+    }
+    cout << "map per layer\tbuilds per pass: " << subm_w.size() << "\tmap build: " << per_layer_build / iterations << "s\tpass: " << per_layer_time / iterations << "s" << endl;
+    cout << "shared maps\tbuilds per pass: " << shared_misses << " (hits: " << shared_hits << ")\tmap build: " << shared_build / iterations
+         << "s\tpass: " << shared_time / iterations << "s" << endl;
+    cout << "###@@@ Time saved by the kernel-map cache on the submanifold stack: " << 100.0 * (per_layer_time - shared_time) / per_layer_time << "%." << endl;
+    cout << endl;
+
+    return 0;
+}
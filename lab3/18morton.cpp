@@ -0,0 +1,288 @@
+#include <sys/time.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <unistd.h>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <unordered_map>
+#include <cassert>
+
+using namespace std;
+
+/*
+ Morton (Z-order) sorted active sites for the sparse gather-scatter. The sites of the
+ 64x4096 cloud are sorted by interleaving the bits of h and w, features are stored in
+ that order, and the rulebook is grouped by blocks of RULE_BLOCK consecutive output
+ sites so a block only gathers from the compact Morton neighbourhood around it while
+ its outputs stay in cache.
+
+ Cache misses are read from the hardware counter when perf_event_open is allowed;
+ otherwise (and always, for a deterministic number) the feature-row accesses of the
+ gather and scatter are replayed through a small set-associative LRU cache model.
+*/
+
+// INITIALIZE paras
+size_t HEIGHT = 64;
+size_t WIDTH = 4096;
+size_t CHANNELS = 32;
+size_t KERNEL_SIZE = 3;
+int iterations = 64;
+const int RULE_BLOCK = 64;
+
+double get_time() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+vector<double> init(const string& filename, size_t rows, size_t cols) {
+    vector<double> cloud(rows * cols, 0.0);
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Failed to open file: " << filename << endl;
+        return cloud;
+    }
+
+    string line;
+    size_t row = 0;
+
+    while (getline(file, line)) { // split the data by line
+        if (row >= rows) break;
+        stringstream ss(line);
+        string value;
+        size_t col = 0;
+
+        while (getline(ss, value, ',')) { // split each line by ","
+            if (col >= cols) break;
+            cloud[row * cols + col] = round(stod(value));
+            col++;
+        }
+        row++;
+    }
+
+    file.close();
+    return cloud;
+}
+
+struct Coord {
+    int h, w;
+};
+
+inline long long coord_key(int h, int w) { return (static_cast<long long>(h) << 32) | static_cast<unsigned>(w); }
+
+// SPREAD the low 16 bits of x to the even bit positions
+inline uint32_t part1by1(uint32_t x) {
+    x &= 0x0000ffff;
+    x = (x | (x << 8)) & 0x00ff00ff;
+    x = (x | (x << 4)) & 0x0f0f0f0f;
+    x = (x | (x << 2)) & 0x33333333;
+    x = (x | (x << 1)) & 0x55555555;
+    return x;
+}
+
+inline uint32_t morton(const Coord& c) { return part1by1(c.w) | (part1by1(c.h) << 1); }
+
+// Rules as flat (in, out) pairs, offset[r] is the kernel offset of rule r
+struct Rulebook {
+    vector<int> in_idx, out_idx, offset;
+    size_t rules() const { return in_idx.size(); }
+};
+
+// BUILD the submanifold rulebook offset by offset, rules of one offset ordered by output site
+Rulebook build_rulebook(const vector<Coord>& coords, int K) {
+    unordered_map<long long, int> index;
+    index.reserve(coords.size());
+    for (size_t i = 0; i < coords.size(); ++i) index.emplace(coord_key(coords[i].h, coords[i].w), i);
+    Rulebook rb;
+    for (int kh = 0; kh < K; ++kh)
+        for (int kw = 0; kw < K; ++kw)
+            for (size_t o = 0; o < coords.size(); ++o) {
+                auto it = index.find(coord_key(coords[o].h + kh - K / 2, coords[o].w + kw - K / 2));
+                if (it == index.end()) continue;
+                rb.in_idx.push_back(it->second);
+                rb.out_idx.push_back(o);
+                rb.offset.push_back(kh * K + kw);
+            }
+    return rb;
+}
+
+// GROUP rules by blocks of RULE_BLOCK output sites, offset-major inside a block
+Rulebook group_by_output_block(const Rulebook& rb) {
+    vector<int> order(rb.rules());
+    for (size_t r = 0; r < order.size(); ++r) order[r] = r;
+    stable_sort(order.begin(), order.end(), [&](int a, int b) { return rb.out_idx[a] / RULE_BLOCK < rb.out_idx[b] / RULE_BLOCK; });
+    Rulebook grouped;
+    for (int r : order) {
+        grouped.in_idx.push_back(rb.in_idx[r]);
+        grouped.out_idx.push_back(rb.out_idx[r]);
+        grouped.offset.push_back(rb.offset[r]);
+    }
+    return grouped;
+}
+
+// EXECUTE submanifold sparse conv, weights [K*K][C][C]
+void sparse_conv(const vector<double>& in, const Rulebook& rb, const vector<double>& weights, int C, vector<double>& out) {
+    fill(out.begin(), out.end(), 0.0);
+    for (size_t r = 0; r < rb.rules(); ++r) {
+        const double* src = &in[size_t(rb.in_idx[r]) * C];
+        double* dst = &out[size_t(rb.out_idx[r]) * C];
+        const double* w = &weights[size_t(rb.offset[r]) * C * C];
+        for (int ic = 0; ic < C; ++ic)
+            for (int oc = 0; oc < C; ++oc) dst[oc] += src[ic] * w[ic * C + oc];
+    }
+}
+
+// Set-associative LRU cache model over 64-byte lines
+struct CacheModel {
+    int sets, ways;
+    vector<uint64_t> tags;
+    vector<uint64_t> stamps;
+    uint64_t clock = 0, accesses = 0, misses = 0;
+
+    CacheModel(size_t bytes, int ways) : sets(bytes / 64 / ways), ways(ways), tags(sets * ways, ~0ULL), stamps(sets * ways, 0) {}
+
+    void touch(uint64_t line) {
+        ++accesses;
+        size_t set = line % sets;
+        uint64_t* t = &tags[set * ways];
+        uint64_t* s = &stamps[set * ways];
+        int victim = 0;
+        for (int i = 0; i < ways; ++i) {
+            if (t[i] == line) {
+                s[i] = ++clock;
+                return;
+            }
+            if (s[i] < s[victim]) victim = i;
+        }
+        ++misses;
+        t[victim] = line;
+        s[victim] = ++clock;
+    }
+
+    // TOUCH every line of a feature row, input and output rows live in disjoint ranges
+    void touch_row(uint64_t base, size_t row, int C) {
+        uint64_t first = (base + row * C * sizeof(double)) / 64, last = (base + (row + 1) * C * sizeof(double) - 1) / 64;
+        for (uint64_t line = first; line <= last; ++line) touch(line);
+    }
+};
+
+// REPLAY the gather / scatter trace of one conv pass, returns the L1 and L2 miss rates in percent of line accesses
+pair<double, double> simulate(const Rulebook& rb, size_t sites, int C) {
+    CacheModel l1(32 << 10, 8), l2(1 << 20, 16);
+    uint64_t in_base = 0, out_base = uint64_t(sites) * C * sizeof(double) + 4096;
+    for (size_t r = 0; r < rb.rules(); ++r) {
+        l1.touch_row(in_base, rb.in_idx[r], C);
+        l2.touch_row(in_base, rb.in_idx[r], C);
+        l1.touch_row(out_base, rb.out_idx[r], C);
+        l2.touch_row(out_base, rb.out_idx[r], C);
+    }
+    return { 100.0 * l1.misses / l1.accesses, 100.0 * l2.misses / l2.accesses };
+}
+
+// Cache misses of this thread through perf_event_open, -1 when the counter is unavailable
+struct MissCounter {
+    int fd = -1;
+    MissCounter() {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+    ~MissCounter() { if (fd >= 0) close(fd); }
+    long long read_count() const {
+        long long value = 0;
+        if (fd < 0 || read(fd, &value, sizeof(value)) != sizeof(value)) return -1;
+        return value;
+    }
+};
+
+struct Layout {
+    string name;
+    vector<Coord> coords;
+    Rulebook rb;
+};
+
+int main() {
+    string filename = "pointcloud.csv";
+    vector<double> cloud = init(filename, HEIGHT, WIDTH);
+    int C = CHANNELS, K = KERNEL_SIZE;
+
+    // ROW-MAJOR sites, the order of generate_none_zero_list in 0sparse.cpp
+    vector<Coord> row_major;
+    for (int h = 0; h < int(HEIGHT); ++h)
+        for (int w = 0; w < int(WIDTH); ++w)
+            if (cloud[size_t(h) * WIDTH + w] != 0.0) row_major.push_back({ h, w });
+    vector<Coord> z_order = row_major;
+    sort(z_order.begin(), z_order.end(), [](const Coord& a, const Coord& b) { return morton(a) < morton(b); });
+
+    vector<Layout> layouts;
+    layouts.push_back({ "row-major, offset-major rules  ", row_major, build_rulebook(row_major, K) });
+    layouts.push_back({ "row-major, output-blocked rules", row_major, group_by_output_block(build_rulebook(row_major, K)) });
+    layouts.push_back({ "Morton, offset-major rules     ", z_order, build_rulebook(z_order, K) });
+    layouts.push_back({ "Morton, output-blocked rules   ", z_order, group_by_output_block(build_rulebook(z_order, K)) });
+
+    vector<double> weights(size_t(K) * K * C * C);
+    for (size_t i = 0; i < weights.size(); ++i) weights[i] = 0.5 / C * (1 + i % 3);
+
+    // FEATURES of site (h, w) are the same in every layout, only their order differs
+    auto site_features = [&](const Coord& c, int ch) { return double((c.h * 31 + c.w * 7 + ch) % 11); };
+
+    cout << endl;
+    cout << "===== MORTON-ORDERED SPARSE CONV C = " << C << ", sites = " << row_major.size() << " =====" << endl;
+    cout << "layout\t\t\t\tL1 miss%(model)\tL2 miss%(model)\tHW misses/iter\ttime" << endl;
+    vector<double> reference;
+    double base_time = 0.0, base_l1 = 0.0;
+    for (const Layout& layout : layouts) {
+        size_t n = layout.coords.size();
+        vector<double> in(n * C), out(n * C);
+        for (size_t i = 0; i < n; ++i)
+            for (int ch = 0; ch < C; ++ch) in[i * C + ch] = site_features(layout.coords[i], ch);
+
+        MissCounter counter;
+        double total = 0.0;
+        long long hw_misses = 0;
+        for (int iter = 0; iter < iterations; iter++) {
+            long long m0 = counter.read_count();
+            auto t = get_time();
+            sparse_conv(in, layout.rb, weights, C, out);
+            total += get_time() - t;
+            hw_misses += counter.read_count() - m0;
+        }
+
+        // CHECK against the row-major result, matched by coordinate
+        unordered_map<long long, size_t> index;
+        for (size_t i = 0; i < n; ++i) index.emplace(coord_key(layout.coords[i].h, layout.coords[i].w), i);
+        if (reference.empty()) reference = out;
+        for (size_t i = 0; i < n; ++i) {
+            size_t j = index[coord_key(row_major[i].h, row_major[i].w)];
+            for (int ch = 0; ch < C; ++ch) assert(fabs(out[j * C + ch] - reference[i * C + ch]) < 1e-9);
+        }
+
+        pair<double, double> miss = simulate(layout.rb, n, C);
+        if (base_time == 0.0) {
+            base_time = total;
+            base_l1 = miss.first;
+        }
+        cout << layout.name << "\t" << miss.first << "\t\t" << miss.second << "\t\t";
+        if (counter.fd >= 0) cout << hw_misses / iterations;
+        else cout << "n/a";
+        cout << "\t\t" << total / iterations << "s" << endl;
+        if (&layout == &layouts.back())
+            cout << "###@@@ Morton + blocked rules: L1 model misses " << miss.first / base_l1 * 100 << "% of row-major, speedup: " << base_time / total << "x." << endl;
+    }
+    cout << endl;
+
+    return 0;
+}
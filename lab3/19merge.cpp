@@ -0,0 +1,250 @@
+#include <sys/time.h>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <unordered_map>
+#include <cassert>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+/*
+ Merge-based kernel map. Active sites are packed into sorted 32-bit keys
+ (h + BIAS) << 16 | (w + BIAS). Shifting every key by the packed kernel offset keeps
+ the array sorted, so the neighbours of all sites at one offset are found by a linear
+ merge of two sorted arrays instead of one hash lookup per site. The merge has a
+ branchless scalar form and an AVX2 form that compares blocks of 8 against 8 keys.
+
+ The three builders (hash table, scalar merge, AVX2 merge) produce the same
+ submanifold rulebook and are timed on random grids of increasing occupancy and on
+ the point cloud itself.
+*/
+
+// INITIALIZE paras
+size_t HEIGHT = 64;
+size_t WIDTH = 4096;
+size_t KERNEL_SIZE = 3;
+int iterations = 8;
+const int BIAS = 8; // keeps h + dh and w + dw non-negative inside their 16-bit fields
+
+double get_time() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+vector<double> init(const string& filename, size_t rows, size_t cols) {
+    vector<double> cloud(rows * cols, 0.0);
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Failed to open file: " << filename << endl;
+        return cloud;
+    }
+
+    string line;
+    size_t row = 0;
+
+    while (getline(file, line)) { // split the data by line
+        if (row >= rows) break;
+        stringstream ss(line);
+        string value;
+        size_t col = 0;
+
+        while (getline(ss, value, ',')) { // split each line by ","
+            if (col >= cols) break;
+            cloud[row * cols + col] = round(stod(value));
+            col++;
+        }
+        row++;
+    }
+
+    file.close();
+    return cloud;
+}
+
+inline uint32_t pack_key(int h, int w) { return uint32_t(h + BIAS) << 16 | uint32_t(w + BIAS); }
+inline int32_t pack_offset(int dh, int dw) { return dh * 65536 + dw; }
+
+// Kernel map: rules of offset k are (in_idx[k][j], out_idx[k][j])
+struct KernelMap {
+    vector<vector<int>> in_idx, out_idx;
+    size_t rules() const {
+        size_t n = 0;
+        for (const auto& r : in_idx) n += r.size();
+        return n;
+    }
+};
+
+// HASH builder: one lookup per (site, offset)
+KernelMap build_hash(const vector<uint32_t>& keys, int K) {
+    unordered_map<uint32_t, int> index;
+    index.reserve(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) index.emplace(keys[i], i);
+    KernelMap km;
+    km.in_idx.assign(K * K, vector<int>());
+    km.out_idx.assign(K * K, vector<int>());
+    for (int kh = 0; kh < K; ++kh)
+        for (int kw = 0; kw < K; ++kw) {
+            int32_t delta = pack_offset(kh - K / 2, kw - K / 2);
+            for (size_t o = 0; o < keys.size(); ++o) {
+                auto it = index.find(keys[o] + delta);
+                if (it == index.end()) continue;
+                km.in_idx[kh * K + kw].push_back(it->second);
+                km.out_idx[kh * K + kw].push_back(o);
+            }
+        }
+    return km;
+}
+
+// MERGE the shifted keys keys[o + ..] + delta against keys[i + ..], branchless scalar form: every step
+// writes the candidate pair and keeps it by advancing the length by (a == b). A match advances both
+// sides, so there are at most min(n - o, n - i) of them and the outputs are sized for that up front
+void merge_tail(const vector<uint32_t>& keys, int32_t delta, size_t o, size_t i, vector<int>& in_idx, vector<int>& out_idx) {
+    size_t n = keys.size(), len = in_idx.size();
+    if (o >= n || i >= n) return;
+    in_idx.resize(len + min(n - o, n - i));
+    out_idx.resize(len + min(n - o, n - i));
+    while (o < n && i < n) {
+        uint32_t a = keys[o] + delta, b = keys[i];
+        in_idx[len] = i;
+        out_idx[len] = o;
+        len += a == b;
+        o += a <= b;
+        i += b <= a;
+    }
+    in_idx.resize(len);
+    out_idx.resize(len);
+}
+
+// MERGE the shifted keys keys[o] + delta against keys, branchless scalar form
+void merge_offset_scalar(const vector<uint32_t>& keys, int32_t delta, vector<int>& in_idx, vector<int>& out_idx) {
+    merge_tail(keys, delta, 0, 0, in_idx, out_idx);
+}
+
+// MERGE with AVX2: 8 shifted keys against 8 input keys per step, all 64 pairs compared
+// by rotating the input block, then the block with the smaller maximum advances
+void merge_offset_simd(const vector<uint32_t>& keys, int32_t delta, vector<int>& in_idx, vector<int>& out_idx) {
+    size_t o = 0, i = 0;
+#ifdef __AVX2__
+    size_t n = keys.size();
+    const __m256i vdelta = _mm256_set1_epi32(delta);
+    const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    while (o + 8 <= n && i + 8 <= n) {
+        __m256i va = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&keys[o])), vdelta);
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&keys[i]));
+        __m256i pos = lanes, match = _mm256_setzero_si256(), found = _mm256_setzero_si256();
+        for (int r = 0; r < 8; ++r) {
+            // lane l of va is compared with input lane pos[l]
+            __m256i eq = _mm256_cmpeq_epi32(va, vb);
+            found = _mm256_or_si256(found, eq);
+            match = _mm256_blendv_epi8(match, pos, eq);
+            vb = _mm256_permutevar8x32_epi32(vb, rotate);
+            pos = _mm256_permutevar8x32_epi32(pos, rotate);
+        }
+        unsigned mask = _mm256_movemask_ps(_mm256_castsi256_ps(found));
+        if (mask) {
+            alignas(32) int32_t idx[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(idx), match);
+            for (; mask; mask &= mask - 1) {
+                int l = __builtin_ctz(mask);
+                in_idx.push_back(i + idx[l]);
+                out_idx.push_back(o + l);
+            }
+        }
+        uint32_t a_max = keys[o + 7] + delta, b_max = keys[i + 7];
+        o += a_max <= b_max ? 8 : 0;
+        i += b_max <= a_max ? 8 : 0;
+    }
+#endif
+    // TAIL with fewer than 8 keys left on one side, branchless scalar merge
+    merge_tail(keys, delta, o, i, in_idx, out_idx);
+}
+
+// MERGE builder: sort the keys once, then one linear merge per offset
+template <typename Merge>
+KernelMap build_merge(vector<uint32_t> keys, int K, Merge merge) {
+    if (!is_sorted(keys.begin(), keys.end())) sort(keys.begin(), keys.end());
+    KernelMap km;
+    km.in_idx.assign(K * K, vector<int>());
+    km.out_idx.assign(K * K, vector<int>());
+    for (int kh = 0; kh < K; ++kh)
+        for (int kw = 0; kw < K; ++kw) {
+            km.in_idx[kh * K + kw].reserve(keys.size());
+            km.out_idx[kh * K + kw].reserve(keys.size());
+            merge(keys, pack_offset(kh - K / 2, kw - K / 2), km.in_idx[kh * K + kw], km.out_idx[kh * K + kw]);
+        }
+    return km;
+}
+
+// Sorted keys of the nonzero sites of a dense grid
+vector<uint32_t> grid_keys(const vector<double>& grid, int height, int width) {
+    vector<uint32_t> keys;
+    for (int h = 0; h < height; ++h)
+        for (int w = 0; w < width; ++w)
+            if (grid[size_t(h) * width + w] != 0.0) keys.push_back(pack_key(h, w));
+    return keys;
+}
+
+template <typename F>
+double time_avg(F&& f) {
+    double total = 0.0;
+    for (int iter = 0; iter < iterations; iter++) {
+        auto t = get_time();
+        f();
+        total += get_time() - t;
+    }
+    return total / iterations;
+}
+
+int main() {
+    string filename = "pointcloud.csv";
+    vector<double> cloud = init(filename, HEIGHT, WIDTH);
+    int K = KERNEL_SIZE;
+
+    struct Grid { string name; vector<uint32_t> keys; };
+    vector<Grid> grids;
+    grids.push_back({ "point cloud", grid_keys(cloud, HEIGHT, WIDTH) });
+    srand(5743);
+    for (double occupancy : { 0.001, 0.01, 0.05, 0.2, 0.5 }) {
+        vector<double> grid(HEIGHT * WIDTH, 0.0);
+        for (double& v : grid) v = rand() / (RAND_MAX + 1.0) < occupancy ? 1.0 : 0.0;
+        grids.push_back({ "random " + to_string(occupancy * 100).substr(0, 4) + "%", grid_keys(grid, HEIGHT, WIDTH) });
+    }
+
+    cout << endl;
+    cout << "===== KERNEL MAP BUILD K = " << K << " on " << HEIGHT << "x" << WIDTH <<
+#ifdef __AVX2__
+        " (AVX2 merge)"
+#else
+        " (no AVX2, SIMD merge falls back to scalar)"
+#endif
+        << " =====" << endl;
+    cout << "grid\t\tsites\trules\thash\t\tmerge\t\tmerge simd\tspeedup(simd vs hash)" << endl;
+    for (const Grid& g : grids) {
+        KernelMap truth = build_hash(g.keys, K);
+        KernelMap scalar = build_merge(g.keys, K, merge_offset_scalar);
+        KernelMap simd = build_merge(g.keys, K, merge_offset_simd);
+        for (int k = 0; k < K * K; ++k) {
+            assert(scalar.in_idx[k] == truth.in_idx[k] && scalar.out_idx[k] == truth.out_idx[k]);
+            assert(simd.in_idx[k] == truth.in_idx[k] && simd.out_idx[k] == truth.out_idx[k]);
+        }
+
+        double hash_time = time_avg([&] { build_hash(g.keys, K); });
+        double merge_time = time_avg([&] { build_merge(g.keys, K, merge_offset_scalar); });
+        double simd_time = time_avg([&] { build_merge(g.keys, K, merge_offset_simd); });
+        cout << g.name << "\t" << g.keys.size() << "\t" << truth.rules() << "\t" << hash_time << "s\t" << merge_time << "s\t" << simd_time
+             << "s\t" << hash_time / simd_time << "x" << endl;
+    }
+    cout << endl;
+
+    return 0;
+}
@@ -182,6 +182,120 @@ vector<vector<vector<vector<double>>>> conv2d_im2col(
 }
 
 
+// OUTPUT tile of the zero-skip path, in output rows x output columns
+const int TILE_H = 4;
+const int TILE_W = 64;
+
+// BUILD summed-area table of input occupancy, sat[b][y][x] = nonzeros of all channels in rows < y, cols < x
+vector<vector<vector<int>>> build_occupancy_sat(const vector<vector<vector<vector<double>>>>& input) {
+    int batch = input.size();
+    int in_channels = input[0].size();
+    int height = input[0][0].size();
+    int width = input[0][0][0].size();
+    vector<vector<vector<int>>> sat(batch, vector<vector<int>>(height + 1, vector<int>(width + 1, 0)));
+    for (int b = 0; b < batch; ++b) {
+        for (int h = 0; h < height; ++h) {
+            int row_sum = 0;
+            for (int w = 0; w < width; ++w) {
+                for (int ic = 0; ic < in_channels; ++ic) row_sum += input[b][ic][h][w] != 0.0;
+                sat[b][h + 1][w + 1] = sat[b][h][w + 1] + row_sum;
+            }
+        }
+    }
+    return sat;
+}
+
+// COUNT nonzeros in input rows [h0, h1) x cols [w0, w1), clipped to the input
+int occupancy(const vector<vector<int>>& sat, int h0, int h1, int w0, int w1) {
+    int height = sat.size() - 1, width = sat[0].size() - 1;
+    h0 = max(h0, 0); w0 = max(w0, 0);
+    h1 = min(h1, height); w1 = min(w1, width);
+    if (h0 >= h1 || w0 >= w1) return 0;
+    return sat[h1][w1] - sat[h0][w1] - sat[h1][w0] + sat[h0][w0];
+}
+
+// MARK im2col rows (output pixels) that lie in a tile whose receptive field holds a nonzero input
+vector<char> active_rows(const vector<vector<vector<vector<double>>>>& input,
+    int KERNEL_SIZE, int STRIDE, int PADDING, double* active_fraction = nullptr) {
+
+    int batch = input.size();
+    int height = input[0][0].size();
+    int width = input[0][0][0].size();
+    int out_height = (height - KERNEL_SIZE + 2 * PADDING) / STRIDE + 1;
+    int out_width = (width - KERNEL_SIZE + 2 * PADDING) / STRIDE + 1;
+    vector<vector<vector<int>>> sat = build_occupancy_sat(input);
+
+    vector<char> active(batch * out_height * out_width, 0);
+    size_t tiles = 0, active_tiles = 0;
+    for (int b = 0; b < batch; ++b) {
+        for (int oh0 = 0; oh0 < out_height; oh0 += TILE_H) {
+            int oh1 = min(out_height, oh0 + TILE_H);
+            for (int ow0 = 0; ow0 < out_width; ow0 += TILE_W) {
+                int ow1 = min(out_width, ow0 + TILE_W);
+                ++tiles;
+                int h0 = oh0 * STRIDE - PADDING, h1 = (oh1 - 1) * STRIDE - PADDING + KERNEL_SIZE;
+                int w0 = ow0 * STRIDE - PADDING, w1 = (ow1 - 1) * STRIDE - PADDING + KERNEL_SIZE;
+                if (occupancy(sat[b], h0, h1, w0, w1) == 0) continue;
+                ++active_tiles;
+                for (int oh = oh0; oh < oh1; ++oh)
+                    for (int ow = ow0; ow < ow1; ++ow)
+                        active[(b * out_height + oh) * out_width + ow] = 1;
+            }
+        }
+    }
+    if (active_fraction) *active_fraction = double(active_tiles) / tiles;
+    return active;
+}
+
+// EXECUTE Conv2D using im2col, skipping tiles with an all-zero receptive field. Their im2col
+// rows would be all zero and their result rows are left at zero, so the output is exact.
+vector<vector<vector<vector<double>>>> conv2d_im2col_skip_zero(
+    const vector<vector<vector<vector<double>>>>& input,
+    const vector<vector<vector<vector<double>>>>& kernel,
+    int STRIDE, int PADDING, double* active_fraction = nullptr) {
+
+    int BATCH = input.size();
+    int IN_CHANNELS = input[0].size();
+    int OUT_CHANNELS = kernel.size();
+    int KERNEL_SIZE = kernel[0][0].size();
+    int HEIGHT = input[0][0].size();
+    int WIDTH = input[0][0][0].size();
+    int out_HEIGHT = (HEIGHT - KERNEL_SIZE + 2 * PADDING) / STRIDE + 1;
+    int out_WIDTH = (WIDTH - KERNEL_SIZE + 2 * PADDING) / STRIDE + 1;
+
+    vector<char> active = active_rows(input, KERNEL_SIZE, STRIDE, PADDING, active_fraction);
+    vector<vector<double>> kernel_matrix = kernel2matrix(kernel);
+    int shared_dim = IN_CHANNELS * KERNEL_SIZE * KERNEL_SIZE;
+    vector<double> col(shared_dim);
+    vector<vector<double>> result(BATCH * out_HEIGHT * out_WIDTH, vector<double>(OUT_CHANNELS, 0));
+
+    // CALCULATE the im2col row and its products only for active output pixels
+    for (int b = 0; b < BATCH; ++b) {
+        for (int h = 0; h < out_HEIGHT; ++h) {
+            for (int w = 0; w < out_WIDTH; ++w) {
+                int i = (b * out_HEIGHT + h) * out_WIDTH + w;
+                if (!active[i]) continue;
+                int row_idx = 0;
+                for (int ic = 0; ic < IN_CHANNELS; ++ic) {
+                    for (int kh = 0; kh < KERNEL_SIZE; ++kh) {
+                        for (int kw = 0; kw < KERNEL_SIZE; ++kw) {
+                            int h_offset = h * STRIDE + kh - PADDING;
+                            int w_offset = w * STRIDE + kw - PADDING;
+                            col[row_idx++] = (h_offset >= 0 && h_offset < HEIGHT && w_offset >= 0 && w_offset < WIDTH) ? input[b][ic][h_offset][w_offset] : 0;
+                        }
+                    }
+                }
+                for (int j = 0; j < OUT_CHANNELS; ++j) {
+                    for (int k = 0; k < shared_dim; ++k) {
+                        result[i][j] += col[k] * kernel_matrix[j][k];
+                    }
+                }
+            }
+        }
+    }
+    return format_col2output(result, BATCH, OUT_CHANNELS, out_HEIGHT, out_WIDTH);
+}
+
 int main() {
     string filename = "pointcloud.csv";
     init(filename, HEIGHT, WIDTH);
@@ -198,6 +312,24 @@ int main() {
     }
     cout << "###@@@ Avg Time for Calculation(im2col_conv, out_channel = " << OUT_CHANNELS << "): " << avg_time / iterations << "s." << endl;
     cout << endl;
+
+    // CHECK the zero-skip conv is exact, on the first few channels to keep memory low
+    vector<vector<vector<vector<double>>>> kernel_head(kernel.begin(), kernel.begin() + min<size_t>(8, OUT_CHANNELS));
+    assert(conv2d_im2col_skip_zero(input, kernel_head, STRIDE, PADDING) == conv2d_im2col(input, kernel_head, STRIDE, PADDING));
+
+    double input_occupancy = occupancy(build_occupancy_sat(input)[0], 0, HEIGHT, 0, WIDTH) / double(HEIGHT * WIDTH * IN_CHANNELS);
+    double active_fraction = 0.0;
+    cout << "===== ZERO-SKIP im2col CONV OUT_CHANNELS = " << OUT_CHANNELS << " =====" << endl;
+    double skip_time = 0.0;
+    for (int iter = 0; iter < iterations; iter++) {
+        auto t = get_time();
+        vector<vector<vector<vector<double>>>> output = conv2d_im2col_skip_zero(input, kernel, STRIDE, PADDING, &active_fraction);
+        cout << "Rnd:" << iter+1 << "\tTime:" << get_time() - t << "s\tOutput_shape: [" << output.size() << ", " << output[0].size() << ", " << output[0][0].size() << ", " << output[0][0][0].size() << "]" << endl;
+        skip_time += get_time() - t;
+    }
+    cout << "###@@@ Avg Time for Calculation(zero-skip im2col_conv, out_channel = " << OUT_CHANNELS << "): " << skip_time / iterations << "s, input occupancy: "
+         << input_occupancy * 100 << "%, active tiles (" << TILE_H << "x" << TILE_W << "): " << active_fraction * 100 << "%, speedup: " << avg_time / skip_time << "x." << endl;
+    cout << endl;
     
     return 0;
 }
\ No newline at end of file
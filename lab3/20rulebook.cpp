@@ -0,0 +1,360 @@
+#include <sys/time.h>
+#include <malloc.h>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include <cassert>
+
+using namespace std;
+
+/*
+ Compact rulebook encodings for the sparse conv of 0sparse.cpp. generate_rulebook()
+ there used to keep every rule as a heap vector<double>(3); 0sparse.cpp now builds the
+ SoA32 encoding below. Here the same rules are stored as
+   AoS      vector<vector<double>> {in, out, kernel offset}, the pre-SoA baseline layout
+   SoA32    per-offset contiguous uint32 in / out arrays
+   SoA16    per-offset blocks with a uint32 base and uint16 in / out deltas to it
+   varint   per-offset delta + zigzag + LEB128 byte streams, for storage only; it is
+            decoded back to SoA32 before the conv
+ and the gather-scatter runs over each (SoA32 also with software prefetch). Rulebook
+ memory is the heap growth measured by mallinfo2 while building it.
+*/
+
+// INITIALIZE paras
+const int HEIGHT_FEATURE = 64;
+const int WIDTH_FEATURE = 4096;
+const int OUT_CHANNELS = 128;
+const int KERNEL_SIZE = 3;
+const int PADDING = 0;
+const int OUTPUT_HEIGHT = HEIGHT_FEATURE - KERNEL_SIZE + 2 * PADDING + 1;
+const int OUTPUT_WIDTH = WIDTH_FEATURE - KERNEL_SIZE + 2 * PADDING + 1;
+const int iterations = 32;
+const int PREFETCH_DISTANCE = 8;
+
+double get_time() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+vector<double> init(const string& filename, size_t rows, size_t cols) {
+    vector<double> cloud(rows * cols, 0.0);
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Failed to open file: " << filename << endl;
+        return cloud;
+    }
+
+    string line;
+    size_t row = 0;
+
+    while (getline(file, line)) { // split the data by line
+        if (row >= rows) break;
+        stringstream ss(line);
+        string value;
+        size_t col = 0;
+
+        while (getline(ss, value, ',')) { // split each line by ","
+            if (col >= cols) break;
+            cloud[row * cols + col] = round(stod(value));
+            col++;
+        }
+        row++;
+    }
+
+    file.close();
+    return cloud;
+}
+
+size_t heap_in_use() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd; // large blocks are mmap'ed and only counted in hblkhd
+}
+
+// Rules as produced by the kernel-map step, before any encoding
+struct RawRules {
+    int sites_in = 0, sites_out = 0;
+    vector<double> in_features;              // [n_in], one input channel
+    vector<vector<pair<int, int>>> by_offset; // (in, out) per kernel offset
+};
+
+// MAP the nonzero sites to the dilated output sites, offset by offset
+RawRules build_rules(const vector<double>& cloud) {
+    RawRules r;
+    vector<int> h_of, w_of;
+    for (int h = 0; h < HEIGHT_FEATURE; ++h)
+        for (int w = 0; w < WIDTH_FEATURE; ++w)
+            if (cloud[size_t(h) * WIDTH_FEATURE + w] != 0.0) {
+                h_of.push_back(h);
+                w_of.push_back(w);
+                r.in_features.push_back(cloud[size_t(h) * WIDTH_FEATURE + w]);
+            }
+    r.sites_in = h_of.size();
+    unordered_map<int, int> out_index;
+    r.by_offset.assign(KERNEL_SIZE * KERNEL_SIZE, vector<pair<int, int>>());
+    for (int i = 0; i < r.sites_in; ++i)
+        for (int kh = 0; kh < KERNEL_SIZE; ++kh)
+            for (int kw = 0; kw < KERNEL_SIZE; ++kw) {
+                int oh = h_of[i] - kh + PADDING, ow = w_of[i] - kw + PADDING;
+                if (oh < 0 || oh >= OUTPUT_HEIGHT || ow < 0 || ow >= OUTPUT_WIDTH) continue;
+                auto inserted = out_index.emplace(oh * OUTPUT_WIDTH + ow, int(out_index.size()));
+                r.by_offset[kh * KERNEL_SIZE + kw].push_back({ i, inserted.first->second });
+            }
+    r.sites_out = out_index.size();
+    return r;
+}
+
+// AoS, one heap vector per rule: [input_index, output_index, kernel_index]
+vector<vector<double>> encode_aos(const RawRules& r) {
+    vector<vector<double>> rulebook;
+    size_t total = 0;
+    for (const auto& rules : r.by_offset) total += rules.size();
+    rulebook.reserve(total);
+    for (size_t k = 0; k < r.by_offset.size(); ++k)
+        for (const auto& p : r.by_offset[k]) rulebook.push_back({ double(p.first), double(p.second), double(k) });
+    return rulebook;
+}
+
+struct SoA32 {
+    vector<uint32_t> offset_ptr; // offset k owns rules [offset_ptr[k], offset_ptr[k + 1])
+    vector<uint32_t> in_idx, out_idx;
+};
+
+SoA32 encode_soa32(const RawRules& r) {
+    SoA32 rb;
+    size_t total = 0;
+    for (const auto& rules : r.by_offset) total += rules.size();
+    rb.in_idx.reserve(total);
+    rb.out_idx.reserve(total);
+    rb.offset_ptr.push_back(0);
+    for (const auto& rules : r.by_offset) {
+        for (const auto& p : rules) {
+            rb.in_idx.push_back(p.first);
+            rb.out_idx.push_back(p.second);
+        }
+        rb.offset_ptr.push_back(rb.in_idx.size());
+    }
+    return rb;
+}
+
+// Blocks of one offset whose indices all fit in 16 bits above the block's bases
+struct SoA16 {
+    struct Block {
+        uint32_t offset, begin, end, in_base, out_base;
+    };
+    vector<Block> blocks;
+    vector<uint16_t> in_idx, out_idx;
+};
+
+SoA16 encode_soa16(const RawRules& r) {
+    SoA16 rb;
+    for (size_t k = 0; k < r.by_offset.size(); ++k) {
+        const auto& rules = r.by_offset[k];
+        size_t j = 0;
+        while (j < rules.size()) {
+            // OPEN a block at the smallest indices of the run it can cover
+            SoA16::Block b = { uint32_t(k), uint32_t(rb.in_idx.size()), 0, uint32_t(rules[j].first), uint32_t(rules[j].second) };
+            size_t end = j;
+            int in_lo = rules[j].first, in_hi = in_lo, out_lo = rules[j].second, out_hi = out_lo;
+            while (end < rules.size()) {
+                int a = min(in_lo, rules[end].first), b2 = max(in_hi, rules[end].first);
+                int c = min(out_lo, rules[end].second), d = max(out_hi, rules[end].second);
+                if (b2 - a > 0xffff || d - c > 0xffff) break;
+                in_lo = a; in_hi = b2; out_lo = c; out_hi = d;
+                ++end;
+            }
+            b.in_base = in_lo;
+            b.out_base = out_lo;
+            for (; j < end; ++j) {
+                rb.in_idx.push_back(uint16_t(rules[j].first - in_lo));
+                rb.out_idx.push_back(uint16_t(rules[j].second - out_lo));
+            }
+            b.end = rb.in_idx.size();
+            rb.blocks.push_back(b);
+        }
+    }
+    rb.blocks.shrink_to_fit();
+    rb.in_idx.shrink_to_fit();
+    rb.out_idx.shrink_to_fit();
+    return rb;
+}
+
+// Delta + zigzag + LEB128 streams per offset, one for the inputs and one for the outputs
+struct VarintRulebook {
+    vector<uint32_t> counts;
+    vector<uint8_t> in_bytes, out_bytes;
+};
+
+void put_varint(vector<uint8_t>& bytes, int64_t delta) {
+    uint64_t z = (uint64_t(delta) << 1) ^ uint64_t(delta >> 63);
+    while (z >= 0x80) {
+        bytes.push_back(uint8_t(z) | 0x80);
+        z >>= 7;
+    }
+    bytes.push_back(uint8_t(z));
+}
+
+int64_t get_varint(const uint8_t*& p) {
+    uint64_t z = 0;
+    int shift = 0;
+    while (*p & 0x80) {
+        z |= uint64_t(*p++ & 0x7f) << shift;
+        shift += 7;
+    }
+    z |= uint64_t(*p++) << shift;
+    return int64_t(z >> 1) ^ -int64_t(z & 1);
+}
+
+VarintRulebook encode_varint(const SoA32& rb) {
+    VarintRulebook v;
+    for (size_t k = 0; k + 1 < rb.offset_ptr.size(); ++k) {
+        v.counts.push_back(rb.offset_ptr[k + 1] - rb.offset_ptr[k]);
+        int64_t prev_in = 0, prev_out = 0;
+        for (uint32_t j = rb.offset_ptr[k]; j < rb.offset_ptr[k + 1]; ++j) {
+            put_varint(v.in_bytes, int64_t(rb.in_idx[j]) - prev_in);
+            put_varint(v.out_bytes, int64_t(rb.out_idx[j]) - prev_out);
+            prev_in = rb.in_idx[j];
+            prev_out = rb.out_idx[j];
+        }
+    }
+    v.in_bytes.shrink_to_fit();
+    v.out_bytes.shrink_to_fit();
+    return v;
+}
+
+SoA32 decode_varint(const VarintRulebook& v) {
+    SoA32 rb;
+    rb.offset_ptr.push_back(0);
+    const uint8_t* pin = v.in_bytes.data();
+    const uint8_t* pout = v.out_bytes.data();
+    for (uint32_t count : v.counts) {
+        int64_t in = 0, out = 0;
+        for (uint32_t j = 0; j < count; ++j) {
+            in += get_varint(pin);
+            out += get_varint(pout);
+            rb.in_idx.push_back(in);
+            rb.out_idx.push_back(out);
+        }
+        rb.offset_ptr.push_back(rb.in_idx.size());
+    }
+    return rb;
+}
+
+// GATHER-SCATTER over the AoS rulebook, every field is a double behind a pointer
+void conv_aos(const vector<vector<double>>& rulebook, const vector<double>& in, const vector<double>& kernel_t, vector<double>& out) {
+    fill(out.begin(), out.end(), 0.0);
+    for (size_t i = 0; i < rulebook.size(); ++i) {
+        size_t input_index = rulebook[i][0];
+        size_t output_index = rulebook[i][1];
+        size_t kernel_index = rulebook[i][2];
+        double v = in[input_index];
+        const double* w = &kernel_t[kernel_index * OUT_CHANNELS];
+        double* dst = &out[output_index * OUT_CHANNELS];
+        for (int oc = 0; oc < OUT_CHANNELS; ++oc) dst[oc] += v * w[oc];
+    }
+}
+
+template <bool PREFETCH>
+void conv_soa32(const SoA32& rb, const vector<double>& in, const vector<double>& kernel_t, vector<double>& out) {
+    fill(out.begin(), out.end(), 0.0);
+    for (size_t k = 0; k + 1 < rb.offset_ptr.size(); ++k) {
+        const double* w = &kernel_t[k * OUT_CHANNELS];
+        uint32_t end = rb.offset_ptr[k + 1];
+        for (uint32_t j = rb.offset_ptr[k]; j < end; ++j) {
+            if (PREFETCH && j + PREFETCH_DISTANCE < end) {
+                // the output row is read-modify-write, OUT_CHANNELS doubles over 16 lines
+                double* next = &out[size_t(rb.out_idx[j + PREFETCH_DISTANCE]) * OUT_CHANNELS];
+                for (int line = 0; line < OUT_CHANNELS; line += 8) __builtin_prefetch(next + line, 1);
+            }
+            double v = in[rb.in_idx[j]];
+            double* dst = &out[size_t(rb.out_idx[j]) * OUT_CHANNELS];
+            for (int oc = 0; oc < OUT_CHANNELS; ++oc) dst[oc] += v * w[oc];
+        }
+    }
+}
+
+void conv_soa16(const SoA16& rb, const vector<double>& in, const vector<double>& kernel_t, vector<double>& out) {
+    fill(out.begin(), out.end(), 0.0);
+    for (const SoA16::Block& b : rb.blocks) {
+        const double* w = &kernel_t[size_t(b.offset) * OUT_CHANNELS];
+        const double* src = &in[b.in_base];
+        double* base = &out[size_t(b.out_base) * OUT_CHANNELS];
+        for (uint32_t j = b.begin; j < b.end; ++j) {
+            double v = src[rb.in_idx[j]];
+            double* dst = base + size_t(rb.out_idx[j]) * OUT_CHANNELS;
+            for (int oc = 0; oc < OUT_CHANNELS; ++oc) dst[oc] += v * w[oc];
+        }
+    }
+}
+
+template <typename F>
+double time_avg(F&& f) {
+    double total = 0.0;
+    for (int iter = 0; iter < iterations; iter++) {
+        auto t = get_time();
+        f();
+        total += get_time() - t;
+    }
+    return total / iterations;
+}
+
+int main() {
+    string filename = "pointcloud.csv";
+    vector<double> cloud = init(filename, HEIGHT_FEATURE, WIDTH_FEATURE);
+    RawRules raw = build_rules(cloud);
+
+    // INITIALIZE kernel, stored [K*K][OC] so a rule reads one contiguous weight row
+    vector<double> kernel_t(KERNEL_SIZE * KERNEL_SIZE * OUT_CHANNELS);
+    for (size_t i = 0; i < kernel_t.size(); ++i) kernel_t[i] = 0.5 + 0.125 * (i % 5);
+
+    size_t heap = heap_in_use();
+    vector<vector<double>> aos = encode_aos(raw);
+    size_t aos_bytes = heap_in_use() - heap;
+
+    heap = heap_in_use();
+    SoA32 soa32 = encode_soa32(raw);
+    size_t soa32_bytes = heap_in_use() - heap;
+
+    heap = heap_in_use();
+    SoA16 soa16 = encode_soa16(raw);
+    size_t soa16_bytes = heap_in_use() - heap;
+
+    heap = heap_in_use();
+    VarintRulebook varint = encode_varint(soa32);
+    size_t varint_bytes = heap_in_use() - heap;
+    SoA32 decoded = decode_varint(varint);
+    assert(decoded.in_idx == soa32.in_idx && decoded.out_idx == soa32.out_idx && decoded.offset_ptr == soa32.offset_ptr);
+    double decode_time = time_avg([&] { decode_varint(varint); });
+
+    // CHECK every encoding gives the same output features
+    size_t rules = aos.size();
+    vector<double> truth(size_t(raw.sites_out) * OUT_CHANNELS), out(truth.size());
+    conv_aos(aos, raw.in_features, kernel_t, truth);
+    conv_soa32<false>(soa32, raw.in_features, kernel_t, out);
+    assert(out == truth);
+    conv_soa32<true>(soa32, raw.in_features, kernel_t, out);
+    assert(out == truth);
+    conv_soa16(soa16, raw.in_features, kernel_t, out);
+    assert(out == truth);
+
+    double aos_time = time_avg([&] { conv_aos(aos, raw.in_features, kernel_t, out); });
+    double soa32_time = time_avg([&] { conv_soa32<false>(soa32, raw.in_features, kernel_t, out); });
+    double prefetch_time = time_avg([&] { conv_soa32<true>(soa32, raw.in_features, kernel_t, out); });
+    double soa16_time = time_avg([&] { conv_soa16(soa16, raw.in_features, kernel_t, out); });
+
+    cout << endl;
+    cout << "===== COMPACT RULEBOOK OUT_CHANNELS = " << OUT_CHANNELS << ", rules = " << rules << ", sites " << raw.sites_in << " -> " << raw.sites_out << " =====" << endl;
+    cout << "AoS vector<double>(3)\t" << aos_bytes << " B\t(" << double(aos_bytes) / rules << " B/rule)\tconv: " << aos_time << "s" << endl;
+    cout << "SoA uint32\t\t" << soa32_bytes << " B\t(" << double(soa32_bytes) / rules << " B/rule)\tconv: " << soa32_time << "s\t(+prefetch: " << prefetch_time << "s)" << endl;
+    cout << "SoA uint16 blocks\t" << soa16_bytes << " B\t(" << double(soa16_bytes) / rules << " B/rule)\tconv: " << soa16_time << "s\t(" << soa16.blocks.size() << " blocks)" << endl;
+    cout << "delta+varint (storage)\t" << varint_bytes << " B\t(" << double(varint_bytes) / rules << " B/rule)\tdecode to SoA uint32: " << decode_time << "s" << endl;
+    cout << "###@@@ Rulebook memory AoS / SoA uint16: " << double(aos_bytes) / soa16_bytes << "x, sparse conv speedup: " << aos_time / soa16_time << "x." << endl;
+    cout << endl;
+
+    return 0;
+}
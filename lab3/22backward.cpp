@@ -0,0 +1,365 @@
+#include <sys/time.h>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+/*
+ Conv backward pass for on-device fine-tuning, beside the forward passes of 2conv
+ (direct) and 1im2col. For y = conv(x, W) and an upstream gradient dY:
+
+  - direct: dX scatters dY[oc][oh][ow] * W[oc][ic][kh][kw] back to the input pixel it
+    was read from, dW correlates x with dY.
+  - im2col: dX = col2im(dY^T * Wmat), the transposed GEMM gives the gradient of every
+    column-matrix entry and col2im adds it back to its input pixel. dW = dY * cols is
+    split into fixed chunks of GRAD_CHUNK output pixels; chunk c always accumulates into
+    partial [OC x C*K*K] number c % GRAD_PARTIALS, in chunk order, and the partials are
+    summed in partial order, so the result is bit-identical for any thread count and
+    scheduling while the partials stay bounded at GRAD_PARTIALS copies of dW.
+
+ Both are checked against central finite differences of L = sum(y * dY) on a small
+ strided / padded shape, and timed beside the forward pass on the point cloud.
+*/
+
+// INITIALIZE paras
+size_t BATCH = 1;
+size_t HEIGHT = 64;
+size_t WIDTH = 4096;
+size_t IN_CHANNELS = 1;
+size_t OUT_CHANNELS = 16;
+size_t KERNEL_SIZE = 3;
+size_t STRIDE = 1;
+size_t PADDING = 1;
+int iterations = 8;
+const int GRAD_CHUNK = 2048;   // output pixels per dW chunk
+const int GRAD_PARTIALS = 16;  // dW partials, also the most threads the weight gradient uses
+
+double get_time() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+vector<double> init(const string& filename, size_t rows, size_t cols) {
+    vector<double> cloud(rows * cols, 0.0);
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Failed to open file: " << filename << endl;
+        return cloud;
+    }
+
+    string line;
+    size_t row = 0;
+
+    while (getline(file, line)) { // split the data by line
+        if (row >= rows) break;
+        stringstream ss(line);
+        string value;
+        size_t col = 0;
+
+        while (getline(ss, value, ',')) { // split each line by ","
+            if (col >= cols) break;
+            cloud[row * cols + col] = round(stod(value));
+            col++;
+        }
+        row++;
+    }
+
+    file.close();
+    return cloud;
+}
+
+// Shape of one conv layer, tensors are flat: x [N][C][H][W], W [OC][C][K][K], y [N][OC][OH][OW]
+struct ConvShape {
+    int n, c, h, w, oc, k, stride, pad;
+    int oh() const { return (h - k + 2 * pad) / stride + 1; }
+    int ow() const { return (w - k + 2 * pad) / stride + 1; }
+    size_t x_size() const { return size_t(n) * c * h * w; }
+    size_t w_size() const { return size_t(oc) * c * k * k; }
+    size_t y_size() const { return size_t(n) * oc * oh() * ow(); }
+    int col_width() const { return c * k * k; }
+};
+
+// FORWARD direct conv, the loop nest of conv2d in 2conv.cpp
+vector<double> conv2d_forward(const ConvShape& s, const vector<double>& x, const vector<double>& wt) {
+    int OH = s.oh(), OW = s.ow();
+    vector<double> y(s.y_size(), 0.0);
+    for (int b = 0; b < s.n; ++b)
+        for (int oc = 0; oc < s.oc; ++oc)
+            for (int oh = 0; oh < OH; ++oh)
+                for (int ow = 0; ow < OW; ++ow) {
+                    double sum = 0.0;
+                    for (int ic = 0; ic < s.c; ++ic)
+                        for (int kh = 0; kh < s.k; ++kh)
+                            for (int kw = 0; kw < s.k; ++kw) {
+                                int ih = oh * s.stride + kh - s.pad, iw = ow * s.stride + kw - s.pad;
+                                if (ih < 0 || ih >= s.h || iw < 0 || iw >= s.w) continue;
+                                sum += x[((size_t(b) * s.c + ic) * s.h + ih) * s.w + iw] * wt[((size_t(oc) * s.c + ic) * s.k + kh) * s.k + kw];
+                            }
+                    y[((size_t(b) * s.oc + oc) * OH + oh) * OW + ow] = sum;
+                }
+    return y;
+}
+
+// BACKWARD direct conv, input gradient: every dY entry goes back to the pixels it read
+vector<double> conv2d_backward_input(const ConvShape& s, const vector<double>& dy, const vector<double>& wt) {
+    int OH = s.oh(), OW = s.ow();
+    vector<double> dx(s.x_size(), 0.0);
+    for (int b = 0; b < s.n; ++b)
+        for (int oc = 0; oc < s.oc; ++oc)
+            for (int oh = 0; oh < OH; ++oh)
+                for (int ow = 0; ow < OW; ++ow) {
+                    double g = dy[((size_t(b) * s.oc + oc) * OH + oh) * OW + ow];
+                    if (g == 0.0) continue;
+                    for (int ic = 0; ic < s.c; ++ic)
+                        for (int kh = 0; kh < s.k; ++kh)
+                            for (int kw = 0; kw < s.k; ++kw) {
+                                int ih = oh * s.stride + kh - s.pad, iw = ow * s.stride + kw - s.pad;
+                                if (ih < 0 || ih >= s.h || iw < 0 || iw >= s.w) continue;
+                                dx[((size_t(b) * s.c + ic) * s.h + ih) * s.w + iw] += g * wt[((size_t(oc) * s.c + ic) * s.k + kh) * s.k + kw];
+                            }
+                }
+    return dx;
+}
+
+// BACKWARD direct conv, weight gradient: correlate the input with dY
+vector<double> conv2d_backward_weight(const ConvShape& s, const vector<double>& x, const vector<double>& dy) {
+    int OH = s.oh(), OW = s.ow();
+    vector<double> dw(s.w_size(), 0.0);
+    for (int oc = 0; oc < s.oc; ++oc)
+        for (int ic = 0; ic < s.c; ++ic)
+            for (int kh = 0; kh < s.k; ++kh)
+                for (int kw = 0; kw < s.k; ++kw) {
+                    double sum = 0.0;
+                    for (int b = 0; b < s.n; ++b)
+                        for (int oh = 0; oh < OH; ++oh)
+                            for (int ow = 0; ow < OW; ++ow) {
+                                int ih = oh * s.stride + kh - s.pad, iw = ow * s.stride + kw - s.pad;
+                                if (ih < 0 || ih >= s.h || iw < 0 || iw >= s.w) continue;
+                                sum += x[((size_t(b) * s.c + ic) * s.h + ih) * s.w + iw] * dy[((size_t(b) * s.oc + oc) * OH + oh) * OW + ow];
+                            }
+                    dw[((size_t(oc) * s.c + ic) * s.k + kh) * s.k + kw] = sum;
+                }
+    return dw;
+}
+
+// Convert the feature map to the column matrix [N*OH*OW][C*K*K], row order of im2col in 1im2col.cpp
+vector<double> im2col(const ConvShape& s, const vector<double>& x) {
+    int OH = s.oh(), OW = s.ow(), CKK = s.col_width();
+    vector<double> cols(size_t(s.n) * OH * OW * CKK, 0.0);
+    for (int b = 0; b < s.n; ++b)
+        for (int oh = 0; oh < OH; ++oh)
+            for (int ow = 0; ow < OW; ++ow) {
+                double* row = &cols[((size_t(b) * OH + oh) * OW + ow) * CKK];
+                for (int ic = 0; ic < s.c; ++ic)
+                    for (int kh = 0; kh < s.k; ++kh)
+                        for (int kw = 0; kw < s.k; ++kw) {
+                            int ih = oh * s.stride + kh - s.pad, iw = ow * s.stride + kw - s.pad;
+                            if (ih >= 0 && ih < s.h && iw >= 0 && iw < s.w) row[(ic * s.k + kh) * s.k + kw] = x[((size_t(b) * s.c + ic) * s.h + ih) * s.w + iw];
+                        }
+            }
+    return cols;
+}
+
+// SCATTER-ADD the column matrix back to the feature map, the adjoint of im2col
+vector<double> col2im(const ConvShape& s, const vector<double>& cols) {
+    int OH = s.oh(), OW = s.ow(), CKK = s.col_width();
+    vector<double> x(s.x_size(), 0.0);
+    for (int b = 0; b < s.n; ++b)
+        for (int oh = 0; oh < OH; ++oh)
+            for (int ow = 0; ow < OW; ++ow) {
+                const double* row = &cols[((size_t(b) * OH + oh) * OW + ow) * CKK];
+                for (int ic = 0; ic < s.c; ++ic)
+                    for (int kh = 0; kh < s.k; ++kh)
+                        for (int kw = 0; kw < s.k; ++kw) {
+                            int ih = oh * s.stride + kh - s.pad, iw = ow * s.stride + kw - s.pad;
+                            if (ih >= 0 && ih < s.h && iw >= 0 && iw < s.w) x[((size_t(b) * s.c + ic) * s.h + ih) * s.w + iw] += row[(ic * s.k + kh) * s.k + kw];
+                        }
+            }
+    return x;
+}
+
+// FORWARD im2col conv: y[b][oc][p] = sum_k cols[b*P + p][k] * W[oc][k]
+vector<double> conv2d_im2col_forward(const ConvShape& s, const vector<double>& x, const vector<double>& wt) {
+    int P = s.oh() * s.ow(), CKK = s.col_width();
+    vector<double> cols = im2col(s, x);
+    vector<double> y(s.y_size(), 0.0);
+    for (int b = 0; b < s.n; ++b)
+        for (int p = 0; p < P; ++p) {
+            const double* row = &cols[(size_t(b) * P + p) * CKK];
+            for (int oc = 0; oc < s.oc; ++oc) {
+                const double* w = &wt[size_t(oc) * CKK];
+                double sum = 0.0;
+                for (int k = 0; k < CKK; ++k) sum += row[k] * w[k];
+                y[(size_t(b) * s.oc + oc) * P + p] = sum;
+            }
+        }
+    return y;
+}
+
+// BACKWARD im2col conv, input gradient: dcols = dY^T * Wmat, then col2im
+vector<double> conv2d_im2col_backward_input(const ConvShape& s, const vector<double>& dy, const vector<double>& wt) {
+    int P = s.oh() * s.ow(), CKK = s.col_width();
+    vector<double> dcols(size_t(s.n) * P * CKK, 0.0);
+    for (int b = 0; b < s.n; ++b)
+        for (int oc = 0; oc < s.oc; ++oc) {
+            const double* g = &dy[(size_t(b) * s.oc + oc) * P];
+            const double* w = &wt[size_t(oc) * CKK];
+            for (int p = 0; p < P; ++p) {
+                if (g[p] == 0.0) continue;
+                double* row = &dcols[(size_t(b) * P + p) * CKK];
+                for (int k = 0; k < CKK; ++k) row[k] += g[p] * w[k];
+            }
+        }
+    return col2im(s, dcols);
+}
+
+// BACKWARD im2col conv, weight gradient: dW = dY * cols over fixed chunks of output pixels,
+// chunk c goes to partial c % GRAD_PARTIALS, threads own partials round-robin, then the partials are reduced in order
+vector<double> conv2d_im2col_backward_weight(const ConvShape& s, const vector<double>& x, const vector<double>& dy, int threads) {
+    int P = s.oh() * s.ow(), CKK = s.col_width();
+    vector<double> cols = im2col(s, x);
+    size_t pixels = size_t(s.n) * P, chunks = (pixels + GRAD_CHUNK - 1) / GRAD_CHUNK;
+    size_t partials = min<size_t>(chunks, GRAD_PARTIALS);
+    threads = int(min<size_t>(threads, partials));
+    vector<double> partial(partials * s.w_size(), 0.0);
+    auto worker = [&](int t) {
+        for (size_t q = t; q < partials; q += threads) {
+            double* dw = &partial[q * s.w_size()];
+            for (size_t chunk = q; chunk < chunks; chunk += partials) {
+                size_t end = min(pixels, (chunk + 1) * GRAD_CHUNK);
+                for (size_t i = chunk * GRAD_CHUNK; i < end; ++i) {
+                    size_t b = i / P, p = i % P;
+                    const double* row = &cols[i * CKK];
+                    for (int oc = 0; oc < s.oc; ++oc) {
+                        double g = dy[(b * s.oc + oc) * P + p];
+                        if (g == 0.0) continue;
+                        double* d = &dw[size_t(oc) * CKK];
+                        for (int k = 0; k < CKK; ++k) d[k] += g * row[k];
+                    }
+                }
+            }
+        }
+    };
+    vector<thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker, t);
+    worker(0);
+    for (thread& t : pool) t.join();
+
+    // REDUCE in partial order, independent of the thread count
+    vector<double> dw(s.w_size(), 0.0);
+    for (size_t q = 0; q < partials; ++q)
+        for (size_t i = 0; i < dw.size(); ++i) dw[i] += partial[q * s.w_size() + i];
+    return dw;
+}
+
+double dot(const vector<double>& a, const vector<double>& b) {
+    double sum = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+vector<double> random_vector(size_t n) {
+    vector<double> v(n);
+    for (double& e : v) e = rand() / (RAND_MAX + 1.0) * 2.0 - 1.0;
+    return v;
+}
+
+// CHECK a gradient against central differences of L(v) = sum(conv(...) * dY), entry by entry
+template <typename Loss>
+void check_gradient(vector<double> v, const vector<double>& grad, Loss loss, const string& name) {
+    const double eps = 1e-4;
+    double worst = 0.0;
+    for (size_t i = 0; i < v.size(); ++i) {
+        double saved = v[i];
+        v[i] = saved + eps;
+        double up = loss(v);
+        v[i] = saved - eps;
+        double down = loss(v);
+        v[i] = saved;
+        double numeric = (up - down) / (2 * eps);
+        worst = max(worst, fabs(numeric - grad[i]) / max(1.0, fabs(numeric)));
+    }
+    cout << "finite difference " << name << ": max rel error " << worst << endl;
+    assert(worst < 1e-7);
+}
+
+void assert_close(const vector<double>& a, const vector<double>& b) {
+    assert(a.size() == b.size());
+    for (size_t i = 0; i < a.size(); ++i) assert(fabs(a[i] - b[i]) <= 1e-9 * max(1.0, fabs(a[i])));
+}
+
+int main() {
+    string filename = "pointcloud.csv";
+    int threads = max(1u, thread::hardware_concurrency());
+    srand(5743);
+
+    // GRADIENT CHECK on a small strided and padded shape with batch and channels
+    cout << endl;
+    ConvShape small = { 2, 3, 9, 11, 4, 3, 2, 1 };
+    vector<double> x = random_vector(small.x_size()), wt = random_vector(small.w_size()), dy = random_vector(small.y_size());
+    vector<double> dx = conv2d_backward_input(small, dy, wt), dw = conv2d_backward_weight(small, x, dy);
+    check_gradient(x, dx, [&](const vector<double>& v) { return dot(conv2d_forward(small, v, wt), dy); }, "dX (direct)");
+    check_gradient(wt, dw, [&](const vector<double>& v) { return dot(conv2d_forward(small, x, v), dy); }, "dW (direct)");
+    assert_close(conv2d_im2col_forward(small, x, wt), conv2d_forward(small, x, wt));
+    assert_close(conv2d_im2col_backward_input(small, dy, wt), dx);
+    assert_close(conv2d_im2col_backward_weight(small, x, dy, 1), dw);
+    assert(conv2d_im2col_backward_weight(small, x, dy, 3) == conv2d_im2col_backward_weight(small, x, dy, 1));
+
+    // BENCHMARK on the point cloud, dY drawn at random
+    ConvShape s = { int(BATCH), int(IN_CHANNELS), int(HEIGHT), int(WIDTH), int(OUT_CHANNELS), int(KERNEL_SIZE), int(STRIDE), int(PADDING) };
+    x = init(filename, HEIGHT, WIDTH);
+    wt.assign(s.w_size(), 0.5);
+    dy = random_vector(s.y_size());
+    vector<double> dw_serial = conv2d_im2col_backward_weight(s, x, dy, 1);
+    assert(conv2d_im2col_backward_weight(s, x, dy, 4) == dw_serial);       // deterministic reduction
+    assert(conv2d_im2col_backward_weight(s, x, dy, threads) == dw_serial);
+    assert(conv2d_im2col_backward_weight(s, x, dy, 2 * GRAD_PARTIALS) == dw_serial); // more threads than partials
+    assert_close(dw_serial, conv2d_backward_weight(s, x, dy));
+    assert_close(conv2d_im2col_backward_input(s, dy, wt), conv2d_backward_input(s, dy, wt));
+
+    cout << "===== CONV BACKWARD " << s.c << "x" << s.h << "x" << s.w << " -> " << s.oc << "x" << s.oh() << "x" << s.ow() << ", K = " << s.k
+         << " (" << threads << " threads) =====" << endl;
+    double fwd_direct = 0.0, fwd_im2col = 0.0, bwd_direct = 0.0, bwd_im2col = 0.0;
+    for (int iter = 0; iter < iterations; iter++) {
+        auto t = get_time();
+        vector<double> y = conv2d_forward(s, x, wt);
+        double t_fwd_direct = get_time() - t;
+
+        t = get_time();
+        y = conv2d_im2col_forward(s, x, wt);
+        double t_fwd_im2col = get_time() - t;
+
+        t = get_time();
+        vector<double> gx = conv2d_backward_input(s, dy, wt);
+        vector<double> gw = conv2d_backward_weight(s, x, dy);
+        double t_bwd_direct = get_time() - t;
+
+        t = get_time();
+        gx = conv2d_im2col_backward_input(s, dy, wt);
+        gw = conv2d_im2col_backward_weight(s, x, dy, threads);
+        double t_bwd_im2col = get_time() - t;
+
+        fwd_direct += t_fwd_direct;
+        fwd_im2col += t_fwd_im2col;
+        bwd_direct += t_bwd_direct;
+        bwd_im2col += t_bwd_im2col;
+        cout << "Rnd:" << iter + 1 << "\tForward direct:" << t_fwd_direct << "s\tForward im2col:" << t_fwd_im2col << "s\tBackward direct:" << t_bwd_direct
+             << "s\tBackward im2col:" << t_bwd_im2col << "s" << endl;
+    }
+    cout << "###@@@ Avg Time for Calculation(forward direct): " << fwd_direct / iterations << "s, (forward im2col): " << fwd_im2col / iterations
+         << "s, (backward direct dX+dW): " << bwd_direct / iterations << "s, (backward im2col dX+dW): " << bwd_im2col / iterations << "s." << endl;
+    cout << "###@@@ Training step (forward + backward), direct: " << (fwd_direct + bwd_direct) / iterations << "s, im2col: " << (fwd_im2col + bwd_im2col) / iterations
+         << "s." << endl;
+    cout << endl;
+
+    return 0;
+}
\ No newline at end of file
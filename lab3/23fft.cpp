@@ -0,0 +1,444 @@
+#include <sys/time.h>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <complex>
+#include <array>
+#include <map>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+/*
+ FFT conv engine for large kernels. Direct conv costs K*K multiply-adds per output and
+ the im2col matrix holds K*K values per output pixel; the FFT path costs O(log T) per
+ pixel for any K. The input is cut into B x B tiles (B = T - K + 1), each tile goes
+ through a real-to-complex 2D FFT of size T x T (two real rows per complex row FFT,
+ only the T/2 + 1 non-redundant columns are kept), and the tile results are summed
+ back overlap-add style. Filters are flipped, transformed once per layer and cached
+ in the FFTConvPlan. For a batch of tiles the per-frequency channel mixing
+ Y_f[OC x tiles] = W_f[OC x IC] * X_f[IC x tiles] is one small complex GEMM per bin.
+
+ conv2d_dispatch() picks direct, im2col or FFT per layer shape: the first layer of a
+ shape times every algorithm once (im2col only while its matrix fits IM2COL_BUDGET)
+ and every later call of that shape runs the winner. fftw is not available here, so
+ the radix-2 FFT is our own.
+*/
+
+// INITIALIZE paras
+size_t BATCH = 1;
+size_t HEIGHT = 64;
+size_t WIDTH = 4096;
+size_t IN_CHANNELS = 2;
+size_t OUT_CHANNELS = 4;
+size_t STRIDE = 1;
+int iterations = 2;
+const int TILE_BATCH = 16;                  // tiles per channel-mixing GEMM
+const size_t IM2COL_BUDGET = size_t(256) << 20; // bytes
+
+double get_time() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+vector<double> init(const string& filename, size_t rows, size_t cols) {
+    vector<double> cloud(rows * cols, 0.0);
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Failed to open file: " << filename << endl;
+        return cloud;
+    }
+
+    string line;
+    size_t row = 0;
+
+    while (getline(file, line)) { // split the data by line
+        if (row >= rows) break;
+        stringstream ss(line);
+        string value;
+        size_t col = 0;
+
+        while (getline(ss, value, ',')) { // split each line by ","
+            if (col >= cols) break;
+            cloud[row * cols + col] = round(stod(value));
+            col++;
+        }
+        row++;
+    }
+
+    file.close();
+    return cloud;
+}
+
+typedef complex<double> cd;
+
+// Plain complex product, keeps the NaN / Inf handling of operator* out of the inner loops
+inline cd mul(const cd& a, const cd& b) { return cd(a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real()); }
+
+// Shape of one conv layer, tensors are flat: x [N][C][H][W], W [OC][C][K][K], y [N][OC][OH][OW]
+struct ConvShape {
+    int n, c, h, w, oc, k, stride, pad;
+    int oh() const { return (h - k + 2 * pad) / stride + 1; }
+    int ow() const { return (w - k + 2 * pad) / stride + 1; }
+    size_t y_size() const { return size_t(n) * oc * oh() * ow(); }
+    array<int, 8> key() const { return { n, c, h, w, oc, k, stride, pad }; }
+};
+
+// Iterative radix-2 FFT of one size, bit-reversal table and roots computed once
+struct FFT1D {
+    int n = 0;
+    vector<int> rev;
+    vector<cd> roots; // exp(-2 pi i j / n), j < n / 2
+
+    FFT1D() {}
+    explicit FFT1D(int n) : n(n), rev(n, 0), roots(n / 2) {
+        int bits = 0;
+        while ((1 << bits) < n) ++bits;
+        for (int i = 1; i < n; ++i) rev[i] = (rev[i >> 1] >> 1) | ((i & 1) << (bits - 1));
+        for (int j = 0; j < n / 2; ++j) roots[j] = polar(1.0, -2.0 * M_PI * j / n);
+    }
+
+    // TRANSFORM a in place, unscaled in both directions
+    void run(cd* a, bool inverse) const {
+        for (int i = 0; i < n; ++i)
+            if (i < rev[i]) swap(a[i], a[rev[i]]);
+        for (int len = 2; len <= n; len <<= 1) {
+            int half = len / 2, step = n / len;
+            for (int i = 0; i < n; i += len)
+                for (int j = 0; j < half; ++j) {
+                    cd w = inverse ? conj(roots[j * step]) : roots[j * step];
+                    cd u = a[i + j], v = mul(a[i + j + half], w);
+                    a[i + j] = u + v;
+                    a[i + j + half] = u - v;
+                }
+        }
+    }
+};
+
+// Real 2D FFT of a T x T tile, half spectrum [T][F] with F = T / 2 + 1
+struct TileFFT {
+    int T = 0, F = 0;
+    FFT1D fft;
+
+    TileFFT() {}
+    explicit TileFFT(int T) : T(T), F(T / 2 + 1), fft(T) {}
+
+    // FORWARD of a real block [rows x cols] (row stride ld), zero padded to T x T.
+    // Rows are transformed two at a time as re + i * im and split by Hermitian symmetry,
+    // the all-zero padding rows are skipped.
+    void forward(const double* src, int rows, int cols, size_t ld, cd* spec, vector<cd>& work) const {
+        fill(spec, spec + size_t(T) * F, cd(0.0, 0.0));
+        work.resize(T);
+        for (int r = 0; r < rows; r += 2) {
+            const double* a = src + r * ld;
+            const double* b = r + 1 < rows ? src + (r + 1) * ld : nullptr;
+            for (int c = 0; c < T; ++c) work[c] = c < cols ? cd(a[c], b ? b[c] : 0.0) : cd(0.0, 0.0);
+            fft.run(work.data(), false);
+            for (int k = 0; k < F; ++k) {
+                cd z = work[k], zn = conj(work[(T - k) & (T - 1)]);
+                spec[size_t(r) * F + k] = (z + zn) * 0.5;
+                if (r + 1 < T) spec[size_t(r + 1) * F + k] = mul(z - zn, cd(0.0, -0.5));
+            }
+        }
+        for (int k = 0; k < F; ++k) {
+            for (int r = 0; r < T; ++r) work[r] = spec[size_t(r) * F + k];
+            fft.run(work.data(), false);
+            for (int r = 0; r < T; ++r) spec[size_t(r) * F + k] = work[r];
+        }
+    }
+
+    // INVERSE of a half spectrum (overwritten) into the real tile dst [T x T], scaled by 1 / T^2
+    void inverse(cd* spec, double* dst, vector<cd>& work) const {
+        work.resize(T);
+        for (int k = 0; k < F; ++k) {
+            for (int r = 0; r < T; ++r) work[r] = spec[size_t(r) * F + k];
+            fft.run(work.data(), true);
+            for (int r = 0; r < T; ++r) spec[size_t(r) * F + k] = work[r];
+        }
+        double scale = 1.0 / (double(T) * T);
+        for (int r = 0; r < T; r += 2) {
+            const cd* x = spec + size_t(r) * F;
+            const cd* y = spec + size_t(r + 1) * F;
+            for (int k = 0; k < T; ++k) {
+                cd xk = k < F ? x[k] : conj(x[T - k]), yk = k < F ? y[k] : conj(y[T - k]);
+                work[k] = xk + mul(cd(0.0, 1.0), yk);
+            }
+            fft.run(work.data(), true);
+            for (int c = 0; c < T; ++c) {
+                dst[size_t(r) * T + c] = work[c].real() * scale;
+                dst[size_t(r + 1) * T + c] = work[c].imag() * scale;
+            }
+        }
+    }
+};
+
+// FFT conv of one layer: tile size, transform and the cached filter spectra [T*F][OC][IC]
+struct FFTConvPlan {
+    ConvShape s;
+    int T, B, bins;
+    TileFFT tile;
+    vector<cd> filter;
+};
+
+// ESTIMATE the FFT work of tile size T over the whole input, in real flops
+double fft_cost(const ConvShape& s, int T) {
+    int B = T - s.k + 1;
+    double tiles = double((s.h + B - 1) / B) * ((s.w + B - 1) / B) * s.n;
+    double row_fft = 5.0 * T * log2(T), F = T / 2 + 1;
+    double forward = s.c * ((B + 1) / 2 + F) * row_fft, inverse = s.oc * (F + T / 2) * row_fft;
+    return tiles * (forward + inverse + 8.0 * T * F * s.c * s.oc);
+}
+
+// PREPARE the plan: cheapest power-of-two tile, flipped filters transformed once
+FFTConvPlan make_fft_plan(const ConvShape& s, const vector<double>& wt) {
+    FFTConvPlan plan;
+    plan.s = s;
+    plan.T = 0;
+    for (int T = 8; T <= 512; T <<= 1) {
+        if (T - s.k + 1 < s.k) continue; // keep at least K new pixels per tile
+        if (plan.T == 0 || fft_cost(s, T) < fft_cost(s, plan.T)) plan.T = T;
+    }
+    plan.B = plan.T - s.k + 1;
+    plan.tile = TileFFT(plan.T);
+    plan.bins = plan.T * plan.tile.F;
+    plan.filter.assign(size_t(plan.bins) * s.oc * s.c, cd(0.0, 0.0));
+    vector<double> flipped(size_t(s.k) * s.k);
+    vector<cd> spec(plan.bins), work;
+    for (int oc = 0; oc < s.oc; ++oc)
+        for (int ic = 0; ic < s.c; ++ic) {
+            const double* w = &wt[(size_t(oc) * s.c + ic) * s.k * s.k];
+            for (int kh = 0; kh < s.k; ++kh)
+                for (int kw = 0; kw < s.k; ++kw) flipped[(s.k - 1 - kh) * s.k + (s.k - 1 - kw)] = w[kh * s.k + kw];
+            plan.tile.forward(flipped.data(), s.k, s.k, s.k, spec.data(), work);
+            for (int f = 0; f < plan.bins; ++f) plan.filter[(size_t(f) * s.oc + oc) * s.c + ic] = spec[f];
+        }
+    return plan;
+}
+
+// EXECUTE FFT conv: full linear conv of every tile with the flipped filter, overlap-added into y.
+// Full-conv pixel (fh, fw) is output (fh - (K - 1 - P), fw - (K - 1 - P)) / STRIDE.
+void conv2d_fft(const FFTConvPlan& plan, const vector<double>& x, vector<double>& y) {
+    const ConvShape& s = plan.s;
+    int T = plan.T, B = plan.B, bins = plan.bins, OH = s.oh(), OW = s.ow(), shift = s.k - 1 - s.pad;
+    int tiles_h = (s.h + B - 1) / B, tiles_w = (s.w + B - 1) / B, tiles = tiles_h * tiles_w;
+    y.assign(s.y_size(), 0.0);
+    vector<cd> xs(size_t(bins) * s.c * TILE_BATCH), ys(size_t(bins) * s.oc * TILE_BATCH), spec(bins), work;
+    vector<double> block(size_t(T) * T);
+    for (int b = 0; b < s.n; ++b)
+        for (int t0 = 0; t0 < tiles; t0 += TILE_BATCH) {
+            int tb = min(TILE_BATCH, tiles - t0);
+
+            // FORWARD every input channel of every tile of the batch, stored [bin][IC][tile]
+            for (int t = 0; t < tb; ++t) {
+                int h0 = (t0 + t) / tiles_w * B, w0 = (t0 + t) % tiles_w * B;
+                for (int ic = 0; ic < s.c; ++ic) {
+                    const double* src = &x[((size_t(b) * s.c + ic) * s.h + h0) * s.w + w0];
+                    plan.tile.forward(src, min(B, s.h - h0), min(B, s.w - w0), s.w, spec.data(), work);
+                    for (int f = 0; f < bins; ++f) xs[(size_t(f) * s.c + ic) * tb + t] = spec[f];
+                }
+            }
+
+            // MIX channels per frequency bin: Y_f[OC x tb] = W_f[OC x IC] * X_f[IC x tb]
+            for (int f = 0; f < bins; ++f) {
+                const cd* wf = &plan.filter[size_t(f) * s.oc * s.c];
+                const cd* xf = &xs[size_t(f) * s.c * tb];
+                cd* yf = &ys[size_t(f) * s.oc * tb];
+                for (int oc = 0; oc < s.oc; ++oc) {
+                    cd* yrow = yf + oc * tb;
+                    for (int t = 0; t < tb; ++t) yrow[t] = cd(0.0, 0.0);
+                    for (int ic = 0; ic < s.c; ++ic) {
+                        cd w = wf[oc * s.c + ic];
+                        const cd* xrow = xf + ic * tb;
+                        for (int t = 0; t < tb; ++t) yrow[t] += mul(w, xrow[t]);
+                    }
+                }
+            }
+
+            // INVERSE every (OC, tile) and overlap-add its T x T block into the output
+            for (int oc = 0; oc < s.oc; ++oc)
+                for (int t = 0; t < tb; ++t) {
+                    for (int f = 0; f < bins; ++f) spec[f] = ys[(size_t(f) * s.oc + oc) * tb + t];
+                    plan.tile.inverse(spec.data(), block.data(), work);
+                    int h0 = (t0 + t) / tiles_w * B - shift, w0 = (t0 + t) % tiles_w * B - shift;
+                    double* out = &y[(size_t(b) * s.oc + oc) * OH * OW];
+                    for (int r = 0; r < T; ++r) {
+                        int fh = h0 + r;
+                        if (fh < 0 || fh % s.stride || fh / s.stride >= OH) continue;
+                        double* out_row = out + size_t(fh / s.stride) * OW;
+                        for (int c = 0; c < T; ++c) {
+                            int fw = w0 + c;
+                            if (fw < 0 || fw % s.stride || fw / s.stride >= OW) continue;
+                            out_row[fw / s.stride] += block[size_t(r) * T + c];
+                        }
+                    }
+                }
+        }
+}
+
+// DIRECT conv, row-wise loop of conv_layer in 6executor.cpp
+void conv2d_direct(const ConvShape& s, const vector<double>& x, const vector<double>& wt, vector<double>& y) {
+    int OH = s.oh(), OW = s.ow(), K = s.k;
+    y.assign(s.y_size(), 0.0);
+    for (int b = 0; b < s.n; ++b)
+        for (int oc = 0; oc < s.oc; ++oc)
+            for (int oh = 0; oh < OH; ++oh) {
+                double* out_row = &y[((size_t(b) * s.oc + oc) * OH + oh) * OW];
+                for (int ic = 0; ic < s.c; ++ic)
+                    for (int kh = 0; kh < K; ++kh) {
+                        int h_offset = oh * s.stride + kh - s.pad;
+                        if (h_offset < 0 || h_offset >= s.h) continue;
+                        const double* in_row = &x[((size_t(b) * s.c + ic) * s.h + h_offset) * s.w];
+                        for (int kw = 0; kw < K; ++kw) {
+                            double k = wt[((size_t(oc) * s.c + ic) * K + kh) * K + kw];
+                            for (int ow = 0; ow < OW; ++ow) {
+                                int w_offset = ow * s.stride + kw - s.pad;
+                                if (w_offset >= 0 && w_offset < s.w) out_row[ow] += in_row[w_offset] * k;
+                            }
+                        }
+                    }
+            }
+}
+
+size_t im2col_bytes(const ConvShape& s) { return size_t(s.n) * s.oh() * s.ow() * s.c * s.k * s.k * sizeof(double); }
+
+// IM2COL conv: column matrix [N*OH*OW][C*K*K] times the kernel matrix [OC][C*K*K]
+void conv2d_im2col(const ConvShape& s, const vector<double>& x, const vector<double>& wt, vector<double>& y) {
+    int P = s.oh() * s.ow(), OW = s.ow(), CKK = s.c * s.k * s.k;
+    vector<double> cols(size_t(s.n) * P * CKK, 0.0);
+    for (int b = 0; b < s.n; ++b)
+        for (int p = 0; p < P; ++p) {
+            double* row = &cols[(size_t(b) * P + p) * CKK];
+            for (int ic = 0; ic < s.c; ++ic)
+                for (int kh = 0; kh < s.k; ++kh)
+                    for (int kw = 0; kw < s.k; ++kw) {
+                        int h_offset = p / OW * s.stride + kh - s.pad, w_offset = p % OW * s.stride + kw - s.pad;
+                        if (h_offset >= 0 && h_offset < s.h && w_offset >= 0 && w_offset < s.w)
+                            row[(ic * s.k + kh) * s.k + kw] = x[((size_t(b) * s.c + ic) * s.h + h_offset) * s.w + w_offset];
+                    }
+        }
+    y.assign(s.y_size(), 0.0);
+    for (int b = 0; b < s.n; ++b)
+        for (int p = 0; p < P; ++p) {
+            const double* row = &cols[(size_t(b) * P + p) * CKK];
+            for (int oc = 0; oc < s.oc; ++oc) {
+                const double* w = &wt[size_t(oc) * CKK];
+                double sum = 0.0;
+                for (int k = 0; k < CKK; ++k) sum += row[k] * w[k];
+                y[(size_t(b) * s.oc + oc) * P + p] = sum;
+            }
+        }
+}
+
+enum ConvAlgo { ALGO_DIRECT, ALGO_IM2COL, ALGO_FFT, ALGO_UNSET };
+const char* algo_name(ConvAlgo a) { return a == ALGO_DIRECT ? "direct" : a == ALGO_IM2COL ? "im2col" : a == ALGO_FFT ? "fft" : "unset"; }
+
+// A layer owns its weights and, once the FFT path was tried, its cached filter spectra
+struct ConvLayer {
+    ConvShape shape;
+    vector<double> weights;
+    unique_ptr<FFTConvPlan> fft;
+};
+
+// Probe timings of the first layer of every shape: direct, im2col (-1 when over budget), fft
+map<array<int, 8>, pair<ConvAlgo, array<double, 3>>> shape_choice;
+
+void run_algo(ConvAlgo algo, ConvLayer& layer, const vector<double>& x, vector<double>& y) {
+    if (algo == ALGO_DIRECT) conv2d_direct(layer.shape, x, layer.weights, y);
+    else if (algo == ALGO_IM2COL) conv2d_im2col(layer.shape, x, layer.weights, y);
+    else {
+        if (!layer.fft) layer.fft.reset(new FFTConvPlan(make_fft_plan(layer.shape, layer.weights)));
+        conv2d_fft(*layer.fft, x, y);
+    }
+}
+
+// DISPATCH to the fastest algorithm of the layer's shape, measured on the first call of that shape
+ConvAlgo conv2d_dispatch(ConvLayer& layer, const vector<double>& x, vector<double>& y) {
+    auto it = shape_choice.find(layer.shape.key());
+    if (it == shape_choice.end()) {
+        array<double, 3> probe = { -1.0, -1.0, -1.0 };
+        ConvAlgo best = ALGO_DIRECT;
+        for (ConvAlgo algo : { ALGO_DIRECT, ALGO_IM2COL, ALGO_FFT }) {
+            if (algo == ALGO_IM2COL && im2col_bytes(layer.shape) > IM2COL_BUDGET) continue;
+            if (algo == ALGO_FFT) run_algo(algo, layer, x, y); // filter transform outside the probe
+            auto t = get_time();
+            run_algo(algo, layer, x, y);
+            probe[algo] = get_time() - t;
+            if (probe[algo] < probe[best]) best = algo;
+        }
+        it = shape_choice.emplace(layer.shape.key(), make_pair(best, probe)).first;
+    }
+    run_algo(it->second.first, layer, x, y);
+    return it->second.first;
+}
+
+double max_error(const vector<double>& a, const vector<double>& b) {
+    double worst = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) worst = max(worst, fabs(a[i] - b[i]) / max(1.0, fabs(b[i])));
+    return worst;
+}
+
+int main() {
+    string filename = "pointcloud.csv";
+    vector<double> cloud = init(filename, HEIGHT, WIDTH);
+
+    // INPUT channels: the cloud and a shifted, scaled copy
+    vector<double> x(BATCH * IN_CHANNELS * HEIGHT * WIDTH);
+    for (size_t ic = 0; ic < IN_CHANNELS; ++ic)
+        for (size_t i = 0; i < HEIGHT * WIDTH; ++i) x[ic * HEIGHT * WIDTH + i] = cloud[(i + ic * 37) % (HEIGHT * WIDTH)] * (1.0 + ic);
+
+    // CHECK the FFT path on odd shapes: batch, stride, padding, tiles cut by the border
+    srand(5743);
+    for (ConvShape s : { ConvShape{ 2, 3, 19, 45, 5, 3, 1, 1 }, ConvShape{ 1, 2, 23, 37, 3, 7, 2, 3 }, ConvShape{ 1, 1, 30, 30, 2, 15, 1, 0 } }) {
+        vector<double> xs(size_t(s.n) * s.c * s.h * s.w), ws(size_t(s.oc) * s.c * s.k * s.k), truth, out;
+        for (double& v : xs) v = rand() / (RAND_MAX + 1.0) - 0.5;
+        for (double& v : ws) v = rand() / (RAND_MAX + 1.0) - 0.5;
+        conv2d_direct(s, xs, ws, truth);
+        conv2d_fft(make_fft_plan(s, ws), xs, out);
+        assert(max_error(out, truth) < 1e-9);
+        conv2d_im2col(s, xs, ws, out);
+        assert(max_error(out, truth) < 1e-9);
+    }
+
+    cout << endl;
+    cout << "===== FFT CONV " << IN_CHANNELS << "x" << HEIGHT << "x" << WIDTH << " -> " << OUT_CHANNELS << " channels =====" << endl;
+    cout << "K\ttile\tfilter fft\tdirect\t\tim2col\t\tfft\t\tmax err\t\tdispatch" << endl;
+    for (int K : { 3, 5, 7, 11, 15 }) {
+        ConvLayer layer;
+        layer.shape = { int(BATCH), int(IN_CHANNELS), int(HEIGHT), int(WIDTH), int(OUT_CHANNELS), K, int(STRIDE), K / 2 };
+        layer.weights.resize(size_t(OUT_CHANNELS) * IN_CHANNELS * K * K);
+        for (size_t i = 0; i < layer.weights.size(); ++i) layer.weights[i] = 0.5 / (K * K) * (1 + i % 3);
+
+        vector<double> y, truth;
+        ConvAlgo chosen = conv2d_dispatch(layer, x, y);
+        conv2d_direct(layer.shape, x, layer.weights, truth);
+        assert(max_error(y, truth) < 1e-9);
+
+        // TIME the layer through the dispatcher, plus the filter transform the plan cached
+        auto t = get_time();
+        FFTConvPlan plan = make_fft_plan(layer.shape, layer.weights);
+        double filter_time = get_time() - t;
+        conv2d_fft(plan, x, y);
+        double err = max_error(y, truth);
+        assert(err < 1e-9);
+        double dispatch_time = 0.0;
+        for (int iter = 0; iter < iterations; iter++) {
+            t = get_time();
+            conv2d_dispatch(layer, x, y);
+            dispatch_time += get_time() - t;
+        }
+        const array<double, 3>& probe = shape_choice[layer.shape.key()].second;
+        cout << K << "\t" << plan.T << "\t" << filter_time << "s\t" << probe[ALGO_DIRECT] << "s\t";
+        if (probe[ALGO_IM2COL] < 0) cout << "over budget\t";
+        else cout << probe[ALGO_IM2COL] << "s\t";
+        cout << probe[ALGO_FFT] << "s\t" << err << "\t" << algo_name(chosen) << " " << dispatch_time / iterations << "s" << endl;
+    }
+    cout << endl;
+
+    return 0;
+}
\ No newline at end of file
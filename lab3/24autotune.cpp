@@ -0,0 +1,563 @@
+#include <sys/time.h>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <array>
+#include <map>
+#include <functional>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+/*
+ Runtime conv algorithm selection. The choice between conv2d (direct), im2col,
+ Winograd F(2x2, 3x3) and sparse (rulebook) conv used to be made by running the lab
+ binaries one by one; here a layer is described by its signature
+ (N, C, H, W, OC, K, stride, padding, density bucket) and AlgoSelector picks the
+ algorithm itself:
+
+  - CostModel predicts the time of every feasible algorithm from its operation counts
+    (MACs, im2col copies, Winograd transforms, rulebook size from the density).
+  - TuningDB is a text file of measured (signature, algorithm, seconds) records. Each
+    algorithm's model is scaled by the geometric mean of measured / predicted over
+    the whole database, so every measurement also sharpens unseen signatures.
+  - With autotuning on, the candidates predicted within TUNE_MARGIN of the best one
+    are timed once on the real input and appended to the database; a signature
+    already in the database is dispatched from its measurements without timing.
+
+ The Winograd candidate is conv2d_winograd_f2x3, the minimal-filtering F(2x2, 3x3)
+ transform. lab2/q2_winograd.cpp's conv2d_winograd is a different algorithm: it keeps
+ the im2col layout and only replaces the GEMM by Winograd's inner-product trick.
+
+ Usage: ./24autotune [--db=conv_tuning.db] [--reset] [--no-tune]
+*/
+
+// INITIALIZE paras
+size_t HEIGHT = 64;
+size_t WIDTH = 4096;
+int iterations = 4;
+const double TUNE_MARGIN = 4.0;                 // time candidates predicted within 4x of the best
+const size_t IM2COL_BUDGET = size_t(256) << 20; // bytes
+
+double get_time() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+vector<double> init(const string& filename, size_t rows, size_t cols) {
+    vector<double> cloud(rows * cols, 0.0);
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Failed to open file: " << filename << endl;
+        return cloud;
+    }
+
+    string line;
+    size_t row = 0;
+
+    while (getline(file, line)) { // split the data by line
+        if (row >= rows) break;
+        stringstream ss(line);
+        string value;
+        size_t col = 0;
+
+        while (getline(ss, value, ',')) { // split each line by ","
+            if (col >= cols) break;
+            cloud[row * cols + col] = round(stod(value));
+            col++;
+        }
+        row++;
+    }
+
+    file.close();
+    return cloud;
+}
+
+// Shape of one conv layer, tensors are flat: x [N][C][H][W], W [OC][C][K][K], y [N][OC][OH][OW]
+struct ConvShape {
+    int n, c, h, w, oc, k, stride, pad;
+    int oh() const { return (h - k + 2 * pad) / stride + 1; }
+    int ow() const { return (w - k + 2 * pad) / stride + 1; }
+    size_t y_size() const { return size_t(n) * oc * oh() * ow(); }
+};
+
+// DIRECT conv, row-wise loop of conv_layer in 6executor.cpp
+void conv2d(const ConvShape& s, const vector<double>& x, const vector<double>& wt, vector<double>& y) {
+    int OH = s.oh(), OW = s.ow(), K = s.k;
+    y.assign(s.y_size(), 0.0);
+    for (int b = 0; b < s.n; ++b)
+        for (int oc = 0; oc < s.oc; ++oc)
+            for (int oh = 0; oh < OH; ++oh) {
+                double* out_row = &y[((size_t(b) * s.oc + oc) * OH + oh) * OW];
+                for (int ic = 0; ic < s.c; ++ic)
+                    for (int kh = 0; kh < K; ++kh) {
+                        int h_offset = oh * s.stride + kh - s.pad;
+                        if (h_offset < 0 || h_offset >= s.h) continue;
+                        const double* in_row = &x[((size_t(b) * s.c + ic) * s.h + h_offset) * s.w];
+                        for (int kw = 0; kw < K; ++kw) {
+                            double k = wt[((size_t(oc) * s.c + ic) * K + kh) * K + kw];
+                            for (int ow = 0; ow < OW; ++ow) {
+                                int w_offset = ow * s.stride + kw - s.pad;
+                                if (w_offset >= 0 && w_offset < s.w) out_row[ow] += in_row[w_offset] * k;
+                            }
+                        }
+                    }
+            }
+}
+
+size_t im2col_bytes(const ConvShape& s) { return size_t(s.n) * s.oh() * s.ow() * s.c * s.k * s.k * sizeof(double); }
+
+// IM2COL conv: column matrix [N*OH*OW][C*K*K] times the kernel matrix [OC][C*K*K]
+void conv2d_im2col(const ConvShape& s, const vector<double>& x, const vector<double>& wt, vector<double>& y) {
+    int P = s.oh() * s.ow(), OW = s.ow(), CKK = s.c * s.k * s.k;
+    vector<double> cols(size_t(s.n) * P * CKK, 0.0);
+    for (int b = 0; b < s.n; ++b)
+        for (int p = 0; p < P; ++p) {
+            double* row = &cols[(size_t(b) * P + p) * CKK];
+            for (int ic = 0; ic < s.c; ++ic)
+                for (int kh = 0; kh < s.k; ++kh)
+                    for (int kw = 0; kw < s.k; ++kw) {
+                        int h_offset = p / OW * s.stride + kh - s.pad, w_offset = p % OW * s.stride + kw - s.pad;
+                        if (h_offset >= 0 && h_offset < s.h && w_offset >= 0 && w_offset < s.w)
+                            row[(ic * s.k + kh) * s.k + kw] = x[((size_t(b) * s.c + ic) * s.h + h_offset) * s.w + w_offset];
+                    }
+        }
+    y.assign(s.y_size(), 0.0);
+    for (int b = 0; b < s.n; ++b)
+        for (int p = 0; p < P; ++p) {
+            const double* row = &cols[(size_t(b) * P + p) * CKK];
+            for (int oc = 0; oc < s.oc; ++oc) {
+                const double* w = &wt[size_t(oc) * CKK];
+                double sum = 0.0;
+                for (int k = 0; k < CKK; ++k) sum += row[k] * w[k];
+                y[(size_t(b) * s.oc + oc) * P + p] = sum;
+            }
+        }
+}
+
+// WINOGRAD F(2x2, 3x3), K = 3 and stride 1 only: U = G g G^T per filter, V = B^T d B per
+// 4x4 input patch, Y = A^T (sum_ic U . V) A per 2x2 output tile
+void conv2d_winograd_f2x3(const ConvShape& s, const vector<double>& x, const vector<double>& wt, vector<double>& y) {
+    assert(s.k == 3 && s.stride == 1);
+    int OH = s.oh(), OW = s.ow(), tiles_h = (OH + 1) / 2, tiles_w = (OW + 1) / 2;
+    vector<double> U(size_t(s.oc) * s.c * 16);
+    for (size_t f = 0; f < size_t(s.oc) * s.c; ++f) {
+        const double* g = &wt[f * 9];
+        double t[4][3]; // G g
+        for (int j = 0; j < 3; ++j) {
+            t[0][j] = g[j];
+            t[1][j] = 0.5 * (g[j] + g[3 + j] + g[6 + j]);
+            t[2][j] = 0.5 * (g[j] - g[3 + j] + g[6 + j]);
+            t[3][j] = g[6 + j];
+        }
+        double* u = &U[f * 16];
+        for (int i = 0; i < 4; ++i) {
+            u[i * 4 + 0] = t[i][0];
+            u[i * 4 + 1] = 0.5 * (t[i][0] + t[i][1] + t[i][2]);
+            u[i * 4 + 2] = 0.5 * (t[i][0] - t[i][1] + t[i][2]);
+            u[i * 4 + 3] = t[i][2];
+        }
+    }
+    y.assign(s.y_size(), 0.0);
+    vector<double> V(size_t(s.c) * 16);
+    for (int b = 0; b < s.n; ++b)
+        for (int th = 0; th < tiles_h; ++th)
+            for (int tw = 0; tw < tiles_w; ++tw) {
+                // TRANSFORM the 4x4 input patch of every channel
+                for (int ic = 0; ic < s.c; ++ic) {
+                    double d[4][4], t[4][4];
+                    for (int i = 0; i < 4; ++i)
+                        for (int j = 0; j < 4; ++j) {
+                            int h = th * 2 + i - s.pad, w = tw * 2 + j - s.pad;
+                            d[i][j] = h >= 0 && h < s.h && w >= 0 && w < s.w ? x[((size_t(b) * s.c + ic) * s.h + h) * s.w + w] : 0.0;
+                        }
+                    for (int j = 0; j < 4; ++j) {
+                        t[0][j] = d[0][j] - d[2][j];
+                        t[1][j] = d[1][j] + d[2][j];
+                        t[2][j] = d[2][j] - d[1][j];
+                        t[3][j] = d[1][j] - d[3][j];
+                    }
+                    double* v = &V[size_t(ic) * 16];
+                    for (int i = 0; i < 4; ++i) {
+                        v[i * 4 + 0] = t[i][0] - t[i][2];
+                        v[i * 4 + 1] = t[i][1] + t[i][2];
+                        v[i * 4 + 2] = t[i][2] - t[i][1];
+                        v[i * 4 + 3] = t[i][1] - t[i][3];
+                    }
+                }
+                // MULTIPLY elementwise, summed over input channels, then the output transform
+                for (int oc = 0; oc < s.oc; ++oc) {
+                    double m[16] = { 0.0 };
+                    for (int ic = 0; ic < s.c; ++ic) {
+                        const double* u = &U[(size_t(oc) * s.c + ic) * 16];
+                        const double* v = &V[size_t(ic) * 16];
+                        for (int e = 0; e < 16; ++e) m[e] += u[e] * v[e];
+                    }
+                    double t[2][4];
+                    for (int j = 0; j < 4; ++j) {
+                        t[0][j] = m[j] + m[4 + j] + m[8 + j];
+                        t[1][j] = m[4 + j] - m[8 + j] - m[12 + j];
+                    }
+                    double* out = &y[(size_t(b) * s.oc + oc) * OH * OW];
+                    for (int i = 0; i < 2; ++i) {
+                        int oh = th * 2 + i;
+                        if (oh >= OH) continue;
+                        out[size_t(oh) * OW + tw * 2] = t[i][0] + t[i][1] + t[i][2];
+                        if (tw * 2 + 1 < OW) out[size_t(oh) * OW + tw * 2 + 1] = t[i][1] - t[i][2] - t[i][3];
+                    }
+                }
+            }
+}
+
+// SPARSE conv: rulebook of (active input site, kernel offset, output pixel), built per call
+void conv2d_sparse(const ConvShape& s, const vector<double>& x, const vector<double>& wt, vector<double>& y) {
+    int OH = s.oh(), OW = s.ow(), K = s.k;
+    size_t plane = size_t(s.h) * s.w;
+    y.assign(s.y_size(), 0.0);
+    vector<double> features(s.c);
+    for (int b = 0; b < s.n; ++b)
+        for (size_t i = 0; i < plane; ++i) {
+            bool active = false;
+            for (int ic = 0; ic < s.c; ++ic) {
+                features[ic] = x[(size_t(b) * s.c + ic) * plane + i];
+                active |= features[ic] != 0.0;
+            }
+            if (!active) continue;
+            int h = i / s.w, w = i % s.w;
+            for (int kh = 0; kh < K; ++kh)
+                for (int kw = 0; kw < K; ++kw) {
+                    int oh = h + s.pad - kh, ow = w + s.pad - kw;
+                    if (oh < 0 || ow < 0 || oh % s.stride || ow % s.stride) continue;
+                    oh /= s.stride;
+                    ow /= s.stride;
+                    if (oh >= OH || ow >= OW) continue;
+                    for (int oc = 0; oc < s.oc; ++oc) {
+                        const double* wk = &wt[(size_t(oc) * s.c * K + kh) * K + kw];
+                        double sum = 0.0;
+                        for (int ic = 0; ic < s.c; ++ic) sum += features[ic] * wk[size_t(ic) * K * K];
+                        y[((size_t(b) * s.oc + oc) * OH + oh) * OW + ow] += sum;
+                    }
+                }
+        }
+}
+
+enum ConvAlgo { ALGO_DIRECT, ALGO_IM2COL, ALGO_WINOGRAD, ALGO_SPARSE, ALGO_COUNT };
+const char* ALGO_NAMES[ALGO_COUNT] = { "conv2d", "im2col", "winograd", "sparse" };
+
+void run_algo(ConvAlgo algo, const ConvShape& s, const vector<double>& x, const vector<double>& wt, vector<double>& y) {
+    if (algo == ALGO_DIRECT) conv2d(s, x, wt, y);
+    else if (algo == ALGO_IM2COL) conv2d_im2col(s, x, wt, y);
+    else if (algo == ALGO_WINOGRAD) conv2d_winograd_f2x3(s, x, wt, y);
+    else conv2d_sparse(s, x, wt, y);
+}
+
+// Fraction of (b, h, w) sites with a nonzero in any channel
+double site_density(const ConvShape& s, const vector<double>& x) {
+    size_t plane = size_t(s.h) * s.w, active = 0;
+    for (int b = 0; b < s.n; ++b)
+        for (size_t i = 0; i < plane; ++i)
+            for (int ic = 0; ic < s.c; ++ic)
+                if (x[(size_t(b) * s.c + ic) * plane + i] != 0.0) {
+                    ++active;
+                    break;
+                }
+    return double(active) / (s.n * plane);
+}
+
+// Layer signature, density kept as half-octave bucket so nearby densities share records
+struct Signature {
+    ConvShape s;
+    int density_bucket;
+    double density() const { return pow(2.0, density_bucket / 2.0); }
+    string key() const {
+        char buf[128];
+        snprintf(buf, sizeof(buf), "%d %d %d %d %d %d %d %d %d", s.n, s.c, s.h, s.w, s.oc, s.k, s.stride, s.pad, density_bucket);
+        return buf;
+    }
+};
+
+Signature make_signature(const ConvShape& s, const vector<double>& x) {
+    double density = site_density(s, x);
+    return { s, density > 0.0 ? int(lround(2.0 * log2(density))) : -60 };
+}
+
+// Analytic time model, seconds per counted operation of every algorithm
+struct CostModel {
+    double mac = 1.0e-9, copy = 2.0e-9, transform = 1.0e-9, rule = 20.0e-9;
+
+    // PREDICT seconds, INFINITY when the algorithm cannot run the shape
+    double predict(const Signature& sig, ConvAlgo algo) const {
+        const ConvShape& s = sig.s;
+        double pixels = double(s.n) * s.oh() * s.ow(), macs = pixels * s.oc * s.c * s.k * s.k;
+        if (algo == ALGO_DIRECT) return macs * mac;
+        if (algo == ALGO_IM2COL) {
+            if (im2col_bytes(s) > IM2COL_BUDGET) return INFINITY;
+            return pixels * s.c * s.k * s.k * copy + macs * mac;
+        }
+        if (algo == ALGO_WINOGRAD) {
+            if (s.k != 3 || s.stride != 1) return INFINITY;
+            double tiles = double(s.n) * ((s.oh() + 1) / 2) * ((s.ow() + 1) / 2);
+            return tiles * (16.0 * s.c * s.oc * mac + (48.0 * s.c + 24.0 * s.oc) * transform);
+        }
+        // SPARSE: every active site reaches about K*K / stride^2 outputs
+        double sites = double(s.n) * s.h * s.w, active = sites * min(1.0, sig.density());
+        double rules = active * s.k * s.k / (s.stride * s.stride);
+        return sites * s.c * copy + rules * (rule + s.oc * s.c * mac);
+    }
+};
+
+// Measured seconds per algorithm of every signature, -1 when not measured
+struct TuningDB {
+    struct Entry {
+        Signature sig;
+        array<double, ALGO_COUNT> seconds;
+    };
+    string path;
+    map<string, Entry> entries;
+
+    // LOAD records "n c h w oc k stride pad density_bucket algo seconds", the fastest per algo wins
+    void load(const string& file) {
+        path = file;
+        entries.clear();
+        ifstream in(path);
+        string line;
+        while (getline(in, line)) {
+            stringstream ss(line);
+            Signature sig;
+            string algo;
+            double seconds;
+            if (!(ss >> sig.s.n >> sig.s.c >> sig.s.h >> sig.s.w >> sig.s.oc >> sig.s.k >> sig.s.stride >> sig.s.pad >> sig.density_bucket >> algo >> seconds)) continue;
+            int a = find(ALGO_NAMES, ALGO_NAMES + ALGO_COUNT, algo) - ALGO_NAMES;
+            if (a < ALGO_COUNT) store(sig, ConvAlgo(a), seconds);
+        }
+    }
+
+    void store(const Signature& sig, ConvAlgo algo, double seconds) {
+        auto it = entries.find(sig.key());
+        if (it == entries.end()) {
+            Entry e = { sig, {} };
+            e.seconds.fill(-1.0);
+            it = entries.emplace(sig.key(), e).first;
+        }
+        double& t = it->second.seconds[algo];
+        t = t < 0 ? seconds : min(t, seconds);
+    }
+
+    // RECORD a measurement and append it to the file
+    void record(const Signature& sig, ConvAlgo algo, double seconds) {
+        store(sig, algo, seconds);
+        ofstream out(path, ios::app);
+        out << sig.key() << " " << ALGO_NAMES[algo] << " " << seconds << "\n";
+    }
+
+    const Entry* find_entry(const Signature& sig) const {
+        auto it = entries.find(sig.key());
+        return it == entries.end() ? nullptr : &it->second;
+    }
+};
+
+struct AlgoSelector {
+    CostModel model;
+    TuningDB db;
+    array<double, ALGO_COUNT> calibration;
+    bool autotune = true;
+
+    // CALIBRATE every algorithm's model by the geometric mean of measured / predicted
+    void calibrate() {
+        for (int a = 0; a < ALGO_COUNT; ++a) {
+            double log_sum = 0.0;
+            int count = 0;
+            for (const auto& e : db.entries) {
+                double predicted = model.predict(e.second.sig, ConvAlgo(a)), measured = e.second.seconds[a];
+                if (measured <= 0 || !isfinite(predicted)) continue;
+                log_sum += log(measured / predicted);
+                ++count;
+            }
+            calibration[a] = count ? exp(log_sum / count) : 1.0;
+        }
+    }
+
+    double predict(const Signature& sig, ConvAlgo algo) const { return model.predict(sig, algo) * calibration[algo]; }
+
+    ConvAlgo predicted_best(const Signature& sig) const {
+        ConvAlgo best = ALGO_DIRECT;
+        for (int a = 0; a < ALGO_COUNT; ++a)
+            if (predict(sig, ConvAlgo(a)) < predict(sig, best)) best = ConvAlgo(a);
+        return best;
+    }
+
+    // SELECT from measurements when the database has them, else from the calibrated model.
+    // With autotune, a signature not yet in the database has its candidates near the predicted best
+    // timed by `measure` first. Once it has records its candidate set is frozen, so a later calibration
+    // cannot pull in another candidate and change a choice that was already dispatched.
+    ConvAlgo select(const Signature& sig, const function<double(ConvAlgo)>& measure, string& source) {
+        ConvAlgo best = predicted_best(sig);
+        bool tuned = false;
+        if (autotune && !db.find_entry(sig)) {
+            double limit = TUNE_MARGIN * predict(sig, best);
+            for (int a = 0; a < ALGO_COUNT; ++a) {
+                if (predict(sig, ConvAlgo(a)) > limit) continue;
+                db.record(sig, ConvAlgo(a), measure(ConvAlgo(a)));
+                tuned = true;
+            }
+            if (tuned) calibrate();
+        }
+        const TuningDB::Entry* e = db.find_entry(sig);
+        ConvAlgo measured = ALGO_COUNT;
+        if (e)
+            for (int a = 0; a < ALGO_COUNT; ++a)
+                if (e->seconds[a] >= 0 && isfinite(model.predict(sig, ConvAlgo(a))) && (measured == ALGO_COUNT || e->seconds[a] < e->seconds[measured])) measured = ConvAlgo(a);
+        if (measured == ALGO_COUNT) { // NO feasible measurement, e.g. only records of an algorithm the shape cannot run
+            source = "model";
+            return predicted_best(sig);
+        }
+        source = tuned ? "tuned" : "db";
+        return measured;
+    }
+};
+
+// DISPATCH a layer to the selected algorithm
+ConvAlgo conv2d_auto(AlgoSelector& selector, const ConvShape& s, const vector<double>& x, const vector<double>& wt, vector<double>& y, string& source) {
+    Signature sig = make_signature(s, x);
+    ConvAlgo algo = selector.select(sig, [&](ConvAlgo a) {
+        auto t = get_time();
+        run_algo(a, s, x, wt, y);
+        return get_time() - t;
+    }, source);
+    run_algo(algo, s, x, wt, y);
+    return algo;
+}
+
+double max_error(const vector<double>& a, const vector<double>& b) {
+    double worst = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) worst = max(worst, fabs(a[i] - b[i]) / max(1.0, fabs(b[i])));
+    return worst;
+}
+
+struct Layer {
+    string name;
+    ConvShape shape;
+    vector<double> input, weights, reference;
+};
+
+int main(int argc, char** argv) {
+    string db_path = "conv_tuning.db";
+    bool reset = false, tune = true;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg.rfind("--db=", 0) == 0) db_path = arg.substr(5);
+        else if (arg == "--reset") reset = true;
+        else if (arg == "--no-tune") tune = false;
+        else {
+            cerr << "Unknown option: " << arg << endl;
+            return 1;
+        }
+    }
+    if (db_path.empty()) {
+        cerr << "Empty --db= path" << endl;
+        return 1;
+    }
+    if (reset) remove(db_path.c_str());
+
+    // CHECK every algorithm against conv2d on odd shapes, padded and not
+    srand(5743);
+    for (ConvShape s : { ConvShape{ 2, 3, 9, 13, 4, 3, 1, 1 }, ConvShape{ 1, 2, 10, 7, 3, 3, 1, 0 }, ConvShape{ 1, 2, 11, 12, 2, 5, 2, 2 } }) {
+        vector<double> x(size_t(s.n) * s.c * s.h * s.w), wt(size_t(s.oc) * s.c * s.k * s.k), truth, out;
+        for (double& v : x) v = rand() % 4 == 0 ? rand() / (RAND_MAX + 1.0) - 0.5 : 0.0;
+        for (double& v : wt) v = rand() / (RAND_MAX + 1.0) - 0.5;
+        conv2d(s, x, wt, truth);
+        for (int a = 0; a < ALGO_COUNT; ++a) {
+            if (a == ALGO_WINOGRAD && (s.k != 3 || s.stride != 1)) continue;
+            run_algo(ConvAlgo(a), s, x, wt, out);
+            assert(max_error(out, truth) < 1e-12);
+        }
+    }
+
+    // LAYERS: the point cloud as is, and wider inputs at increasing density
+    string filename = "pointcloud.csv";
+    vector<double> cloud = init(filename, HEIGHT, WIDTH);
+    vector<Layer> layers;
+    auto add_layer = [&](const string& name, ConvShape s, double density) {
+        Layer l = { name, s, vector<double>(size_t(s.n) * s.c * s.h * s.w), vector<double>(size_t(s.oc) * s.c * s.k * s.k), {} };
+        if (density < 0) {
+            for (size_t i = 0; i < l.input.size(); ++i) l.input[i] = cloud[i % cloud.size()];
+        } else {
+            size_t plane = size_t(s.h) * s.w;
+            for (size_t i = 0; i < l.input.size(); ++i) l.input[i] = rand() / (RAND_MAX + 1.0) < density ? 1.0 + (i / plane) % 3 : 0.0;
+        }
+        for (size_t i = 0; i < l.weights.size(); ++i) l.weights[i] = 0.5 / (s.c * s.k) * (1 + i % 3);
+        conv2d(s, l.input, l.weights, l.reference);
+        layers.push_back(l);
+    };
+    add_layer("cloud 3x3 oc16", { 1, 1, 64, 4096, 16, 3, 1, 1 }, -1);
+    add_layer("cloud 3x3/2 oc64", { 1, 1, 64, 4096, 64, 3, 2, 1 }, -1);
+    add_layer("cloud 5x5 oc16", { 1, 1, 64, 4096, 16, 5, 1, 2 }, -1);
+    add_layer("10%/ch 3x3 c4 oc16", { 1, 4, 64, 1024, 16, 3, 1, 1 }, 0.1);
+    add_layer("dense 3x3 c4 oc16", { 1, 4, 64, 1024, 16, 3, 1, 1 }, 1.0);
+    add_layer("dense 3x3 c16 oc16", { 2, 16, 32, 512, 16, 3, 1, 1 }, 1.0);
+    add_layer("30%/ch 3x3/2 c8", { 1, 8, 64, 1024, 16, 3, 2, 1 }, 0.3);
+    add_layer("dense 5x5 c4 oc8", { 1, 4, 64, 1024, 8, 5, 1, 2 }, 1.0);
+
+    // PASS 1: select with autotuning, records go to the database file
+    AlgoSelector selector;
+    selector.autotune = tune;
+    selector.db.load(db_path);
+    selector.calibrate();
+    size_t records_before = selector.db.entries.size();
+
+    cout << endl;
+    cout << "===== CONV ALGORITHM SELECTION (db: " << db_path << ", " << records_before << " signatures) =====" << endl;
+    cout << "layer\t\t\tdensity\tmodel pick\tchosen (source)\ttime" << endl;
+    vector<ConvAlgo> chosen;
+    int model_hits = 0;
+    for (Layer& l : layers) {
+        ConvAlgo uncalibrated = ALGO_DIRECT;
+        Signature sig = make_signature(l.shape, l.input);
+        for (int a = 0; a < ALGO_COUNT; ++a)
+            if (selector.model.predict(sig, ConvAlgo(a)) < selector.model.predict(sig, uncalibrated)) uncalibrated = ConvAlgo(a);
+
+        vector<double> y;
+        string source;
+        ConvAlgo algo = conv2d_auto(selector, l.shape, l.input, l.weights, y, source);
+        assert(max_error(y, l.reference) < 1e-9);
+        chosen.push_back(algo);
+        model_hits += uncalibrated == algo;
+
+        double total = 0.0;
+        string later;
+        for (int iter = 0; iter < iterations; iter++) {
+            auto t = get_time();
+            conv2d_auto(selector, l.shape, l.input, l.weights, y, later);
+            total += get_time() - t;
+        }
+        cout << l.name << "\t" << sig.density() << "\t" << ALGO_NAMES[uncalibrated] << "\t\t" << ALGO_NAMES[algo] << " (" << source << ")\t" << total / iterations << "s" << endl;
+    }
+    cout << "Calibration (measured / model):";
+    for (int a = 0; a < ALGO_COUNT; ++a) cout << " " << ALGO_NAMES[a] << " " << selector.calibration[a];
+    cout << endl;
+
+    // PASS 2: a fresh selector reloads the file and dispatches every layer without timing
+    AlgoSelector reloaded;
+    reloaded.autotune = false;
+    reloaded.db.load(db_path);
+    reloaded.calibrate();
+    for (size_t i = 0; i < layers.size(); ++i) {
+        vector<double> y;
+        string source;
+        ConvAlgo algo = conv2d_auto(reloaded, layers[i].shape, layers[i].input, layers[i].weights, y, source);
+        assert(!tune || (source == "db" && algo == chosen[i]));
+        assert(max_error(y, layers[i].reference) < 1e-9);
+    }
+    cout << "###@@@ Uncalibrated model agreed with the tuned choice on " << model_hits << "/" << layers.size() << " layers, database now holds "
+         << reloaded.db.entries.size() << " signatures." << endl;
+    cout << endl;
+
+    return 0;
+}
\ No newline at end of file
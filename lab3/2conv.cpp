@@ -100,6 +100,96 @@ vector<vector<vector<vector<double>>>> conv2d(
     return output;
 }
 
+// OUTPUT tile of the zero-skip path, in output rows x output columns
+const int TILE_H = 4;
+const int TILE_W = 64;
+
+// BUILD summed-area table of input occupancy, sat[b][y][x] = nonzeros of all channels in rows < y, cols < x
+vector<vector<vector<int>>> build_occupancy_sat(const vector<vector<vector<vector<double>>>>& input) {
+    int batch = input.size();
+    int in_channels = input[0].size();
+    int height = input[0][0].size();
+    int width = input[0][0][0].size();
+    vector<vector<vector<int>>> sat(batch, vector<vector<int>>(height + 1, vector<int>(width + 1, 0)));
+    for (int b = 0; b < batch; ++b) {
+        for (int h = 0; h < height; ++h) {
+            int row_sum = 0;
+            for (int w = 0; w < width; ++w) {
+                for (int ic = 0; ic < in_channels; ++ic) row_sum += input[b][ic][h][w] != 0.0;
+                sat[b][h + 1][w + 1] = sat[b][h][w + 1] + row_sum;
+            }
+        }
+    }
+    return sat;
+}
+
+// COUNT nonzeros in input rows [h0, h1) x cols [w0, w1), clipped to the input
+int occupancy(const vector<vector<int>>& sat, int h0, int h1, int w0, int w1) {
+    int height = sat.size() - 1, width = sat[0].size() - 1;
+    h0 = max(h0, 0); w0 = max(w0, 0);
+    h1 = min(h1, height); w1 = min(w1, width);
+    if (h0 >= h1 || w0 >= w1) return 0;
+    return sat[h1][w1] - sat[h0][w1] - sat[h1][w0] + sat[h0][w0];
+}
+
+// DEFINE conv function that skips output tiles whose receptive field holds no nonzero input.
+// The output starts at zero and a window of zeros convolves to exactly zero, so the result is exact.
+vector<vector<vector<vector<double>>>> conv2d_skip_zero(
+    const vector<vector<vector<vector<double>>>>& input,
+    const vector<vector<vector<vector<double>>>>& kernel,
+    int STRIDE, int PADDING, double* active_fraction = nullptr) {
+
+    int batch = input.size();
+    int in_channels = input[0].size();
+    int height = input[0][0].size();
+    int width = input[0][0][0].size();
+    int out_channels = kernel.size();
+    int kernel_size = kernel[0][0].size();
+    int out_height = (height - kernel_size + 2 * PADDING) / STRIDE + 1;
+    int out_width = (width - kernel_size + 2 * PADDING) / STRIDE + 1;
+
+    vector<vector<vector<vector<double>>>> output(batch, vector<vector<vector<double>>>(out_channels, vector<vector<double>>(out_height, vector<double>(out_width, 0))));
+    vector<vector<vector<int>>> sat = build_occupancy_sat(input);
+
+    size_t tiles = 0, active = 0;
+    for (int b = 0; b < batch; ++b) {
+        for (int oh0 = 0; oh0 < out_height; oh0 += TILE_H) {
+            int oh1 = min(out_height, oh0 + TILE_H);
+            for (int ow0 = 0; ow0 < out_width; ow0 += TILE_W) {
+                int ow1 = min(out_width, ow0 + TILE_W);
+                ++tiles;
+                // RECEPTIVE field of the tile
+                int h0 = oh0 * STRIDE - PADDING, h1 = (oh1 - 1) * STRIDE - PADDING + kernel_size;
+                int w0 = ow0 * STRIDE - PADDING, w1 = (ow1 - 1) * STRIDE - PADDING + kernel_size;
+                if (occupancy(sat[b], h0, h1, w0, w1) == 0) continue;
+                ++active;
+
+                for (int oc = 0; oc < out_channels; ++oc) {
+                    for (int oh = oh0; oh < oh1; ++oh) {
+                        for (int ow = ow0; ow < ow1; ++ow) {
+                            for (int ic = 0; ic < in_channels; ++ic) {
+                                for (int kh = 0; kh < kernel_size; ++kh) {
+                                    for (int kw = 0; kw < kernel_size; ++kw) {
+                                        int h_offset = oh * STRIDE + kh - PADDING;
+                                        int w_offset = ow * STRIDE + kw - PADDING;
+
+                                        if (h_offset >= 0 && h_offset < height && w_offset >= 0 && w_offset < width) {
+                                            output[b][oc][oh][ow] +=
+                                                input[b][ic][h_offset][w_offset] * kernel[oc][ic][kh][kw];
+                                        }
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    if (active_fraction) *active_fraction = double(active) / tiles;
+    return output;
+}
+
 int main() {
     string filename = "pointcloud.csv";
     init(filename, HEIGHT, WIDTH);
@@ -117,5 +207,23 @@ int main() {
     cout << "###@@@ Avg Time for Calculation(traditional conv out_channel = " << OUT_CHANNELS << "): " << avg_time / iterations << "s." << endl;
     cout << endl;
 
+    // CHECK the zero-skip conv is exact, on the first few channels to keep memory low
+    vector<vector<vector<vector<double>>>> kernel_head(kernel.begin(), kernel.begin() + min<size_t>(8, OUT_CHANNELS));
+    assert(conv2d_skip_zero(input, kernel_head, STRIDE, PADDING) == conv2d(input, kernel_head, STRIDE, PADDING));
+
+    double input_occupancy = occupancy(build_occupancy_sat(input)[0], 0, HEIGHT, 0, WIDTH) / double(HEIGHT * WIDTH * IN_CHANNELS);
+    double active_fraction = 0.0;
+    cout << "===== ZERO-SKIP CONV OUT_CHANNELS = " << OUT_CHANNELS << " =====" << endl;
+    double skip_time = 0.0;
+    for (int iter = 0; iter < iterations; iter++) {
+        auto t = get_time();
+        vector<vector<vector<vector<double>>>> output = conv2d_skip_zero(input, kernel, STRIDE, PADDING, &active_fraction);
+        cout << "Rnd:" << iter+1 << "\tTime:" << get_time() - t << "s\tOutput_shape: [" << output.size() << ", " << output[0].size() << ", " << output[0][0].size() << ", " << output[0][0][0].size() << "]" << endl;
+        skip_time += get_time() - t;
+    }
+    cout << "###@@@ Avg Time for Calculation(zero-skip conv out_channel = " << OUT_CHANNELS << "): " << skip_time / iterations << "s, input occupancy: "
+         << input_occupancy * 100 << "%, active tiles (" << TILE_H << "x" << TILE_W << "): " << active_fraction * 100 << "%, speedup: " << avg_time / skip_time << "x." << endl;
+    cout << endl;
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,231 @@
+#include <sys/time.h>
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <cstdint>
+#include <cassert>
+
+using namespace std;
+
+/*
+ Binary-input convolution: pointcloud.csv only holds 0.0 / 1.0, so the frame is
+ packed into 64-bit words (one bit per voxel) and every 3x3 window is evaluated
+ with popcount over weight bit-planes instead of floating point multiply-adds.
+*/
+
+double get_time() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+const int BATCH = 1; // firmed at 1
+const int HEIGHT_FEATURE = 64;
+const int WIDTH_FEATURE = 4096;
+const int IN_CHANNELS = 1; // firmed at 1
+const int OUT_CHANNELS = 128;
+const int KERNEL_SIZE = 3; // firmed at 3, a window is 9 bits
+const int STRIDE = 1;
+const int PADDING = 0;
+const int OUTPUT_HEIGHT = (HEIGHT_FEATURE - KERNEL_SIZE + 2 * PADDING) / STRIDE + 1;
+const int OUTPUT_WIDTH = (WIDTH_FEATURE - KERNEL_SIZE + 2 * PADDING) / STRIDE + 1;
+const int WORDS_PER_ROW = (WIDTH_FEATURE + 63) / 64;
+const int MAX_PLANES = 8; // weight precision used when weights are not exactly representable
+const int iterations = 32;
+
+vector<vector<vector<vector<double>>>> cloudData(BATCH, vector<vector<vector<double>>>(IN_CHANNELS, vector<vector<double>>(HEIGHT_FEATURE, vector<double>(WIDTH_FEATURE))));
+// INITIALIZE kernel by filling 0.5
+vector<vector<vector<vector<double>>>> kernel(OUT_CHANNELS, vector<vector<vector<double>>>(IN_CHANNELS, vector<vector<double>>(KERNEL_SIZE, vector<double>(KERNEL_SIZE, 0.5))));
+
+// INITIALIZER ONLY for BATCH, IN_CHANNELS firmed at 1, read pointcloud.csv into cloudData
+void init(const string& filename, size_t rows, size_t cols) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Failed to open file: " << filename << endl;
+        return;
+    }
+
+    string line;
+    size_t row = 0;
+
+    while (getline(file, line)) { // split the data by line
+        if (row >= rows) break;
+        stringstream ss(line);
+        string value;
+        size_t col = 0;
+
+        while (getline(ss, value, ',')) { // split each line by ","
+            if (col >= cols) break;
+            cloudData[0][0][row][col] = round(stod(value));
+            col++;
+        }
+        row++;
+    }
+
+    file.close();
+}
+
+// PACK occupancy into bits, column c of a row lives in word c / 64, bit c % 64.
+// One extra zero word per row lets the window reader look one word ahead safely.
+vector<uint64_t> pack_bits(const vector<vector<vector<vector<double>>>>& data) {
+    vector<uint64_t> packed(HEIGHT_FEATURE * (WORDS_PER_ROW + 1), 0);
+    for (int h = 0; h < HEIGHT_FEATURE; h++) {
+        uint64_t* row = &packed[h * (WORDS_PER_ROW + 1)];
+        for (int w = 0; w < WIDTH_FEATURE; w++) {
+            double v = data[0][0][h][w];
+            assert(v == 0.0 || v == 1.0); // binary mode only accepts occupancy grids
+            if (v != 0.0) row[w / 64] |= uint64_t(1) << (w % 64);
+        }
+    }
+    return packed;
+}
+
+// Kernel of one out channel as bit-planes: w[tap] = scale * sum_b 2^b * (pos_b[tap] - neg_b[tap])
+struct BitPlaneKernel {
+    double scale = 0.0;
+    int num_planes = 0;
+    uint16_t pos[MAX_PLANES] = {0};
+    uint16_t neg[MAX_PLANES] = {0};
+};
+
+// DECOMPOSE each filter into the fewest bit-planes that represent it exactly,
+// falling back to MAX_PLANES quantized planes. Returns the max quantization error.
+double prepare_bitplane_kernels(const vector<vector<vector<vector<double>>>>& kernel, vector<BitPlaneKernel>& planes) {
+    double max_err = 0.0;
+    planes.assign(OUT_CHANNELS, BitPlaneKernel());
+    for (int oc = 0; oc < OUT_CHANNELS; oc++) {
+        double max_abs = 0.0;
+        for (int kh = 0; kh < KERNEL_SIZE; kh++)
+            for (int kw = 0; kw < KERNEL_SIZE; kw++)
+                max_abs = max(max_abs, fabs(kernel[oc][0][kh][kw]));
+        BitPlaneKernel& p = planes[oc];
+        if (max_abs == 0.0) continue; // all-zero filter, no planes
+
+        for (int bits = 1; bits <= MAX_PLANES; bits++) {
+            double scale = max_abs / ((1 << bits) - 1);
+            bool exact = true;
+            for (int t = 0; t < KERNEL_SIZE * KERNEL_SIZE && exact; t++) {
+                double q = kernel[oc][0][t / KERNEL_SIZE][t % KERNEL_SIZE] / scale;
+                exact = fabs(q - round(q)) < 1e-9;
+            }
+            if (exact || bits == MAX_PLANES) {
+                p.scale = scale;
+                p.num_planes = bits;
+                break;
+            }
+        }
+
+        for (int t = 0; t < KERNEL_SIZE * KERNEL_SIZE; t++) {
+            double w = kernel[oc][0][t / KERNEL_SIZE][t % KERNEL_SIZE];
+            long q = lround(fabs(w) / p.scale);
+            for (int b = 0; b < p.num_planes; b++) {
+                if (!((q >> b) & 1)) continue;
+                if (w > 0) p.pos[b] |= uint16_t(1) << t;
+                else p.neg[b] |= uint16_t(1) << t;
+            }
+            max_err = max(max_err, fabs(fabs(w) - q * p.scale));
+        }
+    }
+    return max_err;
+}
+
+// READ 64 consecutive bits of a packed row starting at column col
+inline uint64_t read_bits(const uint64_t* row, int col) {
+    int word = col / 64, shift = col % 64;
+    if (shift == 0) return row[word];
+    return (row[word] >> shift) | (row[word + 1] << (64 - shift));
+}
+
+// do binary conv, 9-bit window pattern p (tap kh * 3 + kw) is matched against every plane
+vector<vector<vector<vector<double>>>> binary_conv(const vector<uint64_t>& packed, const vector<BitPlaneKernel>& planes) {
+    vector<vector<vector<vector<double>>>> output(BATCH, vector<vector<vector<double>>>(OUT_CHANNELS, vector<vector<double>>(OUTPUT_HEIGHT, vector<double>(OUTPUT_WIDTH, 0.0))));
+    const int stride_words = WORDS_PER_ROW + 1;
+
+    for (int oh = 0; oh < OUTPUT_HEIGHT; oh++) {
+        const uint64_t* r0 = &packed[(oh * STRIDE) * stride_words];
+        const uint64_t* r1 = r0 + stride_words;
+        const uint64_t* r2 = r1 + stride_words;
+        for (int ow0 = 0; ow0 < OUTPUT_WIDTH; ow0 += 64) {
+            // COLLAPSE the 3x3 receptive field of 64 outputs into one mask, skip empty blocks
+            uint64_t rows_or = read_bits(r0, ow0) | read_bits(r1, ow0) | read_bits(r2, ow0);
+            uint64_t next_or = read_bits(r0, ow0 + 64) | read_bits(r1, ow0 + 64) | read_bits(r2, ow0 + 64);
+            uint64_t any = rows_or | (rows_or >> 1) | (rows_or >> 2) | (next_or << 62) | (next_or << 63);
+            if (any == 0) continue;
+
+            int block = min(64, OUTPUT_WIDTH - ow0);
+            for (int j = 0; j < block; j++) {
+                if (!((any >> j) & 1)) continue;
+                int ow = ow0 + j;
+                uint16_t p = uint16_t((read_bits(r0, ow) & 7) | ((read_bits(r1, ow) & 7) << 3) | ((read_bits(r2, ow) & 7) << 6));
+                for (int oc = 0; oc < OUT_CHANNELS; oc++) {
+                    const BitPlaneKernel& k = planes[oc];
+                    long acc = 0;
+                    for (int b = 0; b < k.num_planes; b++) {
+                        acc += long(__builtin_popcount(p & k.pos[b]) - __builtin_popcount(p & k.neg[b])) << b;
+                    }
+                    output[0][oc][oh][ow] = acc * k.scale;
+                }
+            }
+        }
+    }
+    return output;
+}
+
+// REFERENCE direct conv for checking the binary path
+vector<vector<vector<vector<double>>>> conv2d(
+    const vector<vector<vector<vector<double>>>>& input,
+    const vector<vector<vector<vector<double>>>>& kernel) {
+    vector<vector<vector<vector<double>>>> output(BATCH, vector<vector<vector<double>>>(OUT_CHANNELS, vector<vector<double>>(OUTPUT_HEIGHT, vector<double>(OUTPUT_WIDTH, 0.0))));
+    for (int oc = 0; oc < OUT_CHANNELS; ++oc) {
+        for (int oh = 0; oh < OUTPUT_HEIGHT; ++oh) {
+            for (int ow = 0; ow < OUTPUT_WIDTH; ++ow) {
+                double acc = 0.0;
+                for (int kh = 0; kh < KERNEL_SIZE; ++kh) {
+                    for (int kw = 0; kw < KERNEL_SIZE; ++kw) {
+                        acc += input[0][0][oh * STRIDE + kh][ow * STRIDE + kw] * kernel[oc][0][kh][kw];
+                    }
+                }
+                output[0][oc][oh][ow] = acc;
+            }
+        }
+    }
+    return output;
+}
+
+int main() {
+    string filename = "pointcloud.csv";
+    init(filename, HEIGHT_FEATURE, WIDTH_FEATURE);
+
+    vector<uint64_t> packed = pack_bits(cloudData);
+    vector<BitPlaneKernel> planes;
+    double quant_err = prepare_bitplane_kernels(kernel, planes);
+
+    cout << endl;
+    cout << "===== BINARY CONV OUT_CHANNELS = " << OUT_CHANNELS << " =====" << endl;
+    cout << "Packed frame: " << HEIGHT_FEATURE * WORDS_PER_ROW * sizeof(uint64_t) / 1024 << " KB (fp64 frame: "
+         << HEIGHT_FEATURE * WIDTH_FEATURE * sizeof(double) / 1024 << " KB), planes: " << planes[0].num_planes
+         << ", max weight quantization error: " << quant_err << endl;
+
+    // CHECK against the floating point conv once before timing
+    vector<vector<vector<vector<double>>>> truth = conv2d(cloudData, kernel);
+    vector<vector<vector<vector<double>>>> check = binary_conv(packed, planes);
+    double tolerance = quant_err * KERNEL_SIZE * KERNEL_SIZE + 1e-9;
+    for (int oc = 0; oc < OUT_CHANNELS; oc++)
+        for (int oh = 0; oh < OUTPUT_HEIGHT; oh++)
+            for (int ow = 0; ow < OUTPUT_WIDTH; ow++)
+                assert(fabs(check[0][oc][oh][ow] - truth[0][oc][oh][ow]) <= tolerance);
+
+    double avg_time = 0.0;
+    for (int iter = 0; iter < iterations; iter++) {
+        auto t = get_time();
+        vector<vector<vector<vector<double>>>> output = binary_conv(packed, planes);
+        cout << "Rnd:" << iter + 1 << "\tTime:" << get_time() - t << "s\tOutput_shape: [" << output.size() << ", " << output[0].size() << ", " << output[0][0].size() << ", " << output[0][0][0].size() << "]" << endl;
+        avg_time += get_time() - t;
+    }
+    cout << "###@@@ Avg Time for Calculation(binary_conv, out_channel = " << OUT_CHANNELS << "): " << avg_time / iterations << "s." << endl;
+    cout << endl;
+
+    return 0;
+}
@@ -0,0 +1,256 @@
+#include <sys/time.h>
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <cassert>
+
+using namespace std;
+
+/*
+ Compile-time specialized direct conv. KERNEL_SIZE, STRIDE and PADDING become
+ template parameters for the common 1x1 / 3x3 / 5x5 shapes at stride 1 or 2, so
+ the filter loops are fully unrolled and the interior of the output needs no
+ bounds checks. conv2d_dispatch() picks a specialization at runtime and falls
+ back to the generic conv2d for every other shape.
+*/
+
+// INITIALIZE paras
+size_t BATCH = 1;
+size_t HEIGHT = 64;
+size_t WIDTH = 4096;
+size_t IN_CHANNELS = 1;
+size_t OUT_CHANNELS = 64;
+int iterations = 8;
+
+double get_time() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+vector<vector<vector<vector<double>>>> input(BATCH, vector<vector<vector<double>>>(IN_CHANNELS, vector<vector<double>>(HEIGHT, vector<double>(WIDTH))));
+
+void init(const string& filename, size_t rows, size_t cols) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Failed to open file: " << filename << endl;
+        return;
+    }
+
+    string line;
+    size_t row = 0;
+
+    while (getline(file, line)) { // split the data by line
+        if (row >= rows) break;
+        stringstream ss(line);
+        string value;
+        size_t col = 0;
+
+        while (getline(ss, value, ',')) { // split each line by ","
+            if (col >= cols) break;
+            input[0][0][row][col] = round(stod(value));
+            col++;
+        }
+        row++;
+    }
+
+    file.close();
+}
+
+// DEFINE generic conv function, every shape parameter is a runtime value
+vector<vector<vector<vector<double>>>> conv2d(
+    const vector<vector<vector<vector<double>>>>& input,
+    const vector<vector<vector<vector<double>>>>& kernel,
+    int STRIDE, int PADDING) {
+
+    int batch = input.size();
+    int in_channels = input[0].size();
+    int height = input[0][0].size();
+    int width = input[0][0][0].size();
+    int out_channels = kernel.size();
+    int kernel_size = kernel[0][0].size();
+    int out_height = (height - kernel_size + 2 * PADDING) / STRIDE + 1;
+    int out_width = (width - kernel_size + 2 * PADDING) / STRIDE + 1;
+
+    vector<vector<vector<vector<double>>>> output(batch, vector<vector<vector<double>>>(out_channels, vector<vector<double>>(out_height, vector<double>(out_width, 0))));
+
+    for (int b = 0; b < batch; ++b) {
+        for (int oc = 0; oc < out_channels; ++oc) {
+            for (int oh = 0; oh < out_height; ++oh) {
+                for (int ow = 0; ow < out_width; ++ow) {
+                    for (int ic = 0; ic < in_channels; ++ic) {
+                        for (int kh = 0; kh < kernel_size; ++kh) {
+                            for (int kw = 0; kw < kernel_size; ++kw) {
+                                int h_offset = oh * STRIDE + kh - PADDING;
+                                int w_offset = ow * STRIDE + kw - PADDING;
+
+                                if (h_offset >= 0 && h_offset < height && w_offset >= 0 && w_offset < width) {
+                                    output[b][oc][oh][ow] +=
+                                        input[b][ic][h_offset][w_offset] * kernel[oc][ic][kh][kw];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return output;
+}
+
+// ONE output row of a fixed-shape conv. Columns in [ow_begin, ow_end) have the whole
+// window inside the input, the rest go through the checked border loop.
+template <int K, int S, int P>
+inline void conv_row_fixed(const double* const rows[K], const double (&w)[K][K], double* out,
+                           int width, int out_width, int ow_begin, int ow_end) {
+    auto border = [&](int ow) {
+        double acc = 0.0;
+        for (int kh = 0; kh < K; ++kh) {
+            if (!rows[kh]) continue;
+            for (int kw = 0; kw < K; ++kw) {
+                int w_offset = ow * S + kw - P;
+                if (w_offset >= 0 && w_offset < width) acc += rows[kh][w_offset] * w[kh][kw];
+            }
+        }
+        out[ow] += acc;
+    };
+
+    for (int ow = 0; ow < ow_begin; ++ow) border(ow);
+    for (int ow = ow_begin; ow < ow_end; ++ow) {
+        const int base = ow * S - P;
+        double acc = 0.0;
+#pragma GCC unroll 8
+        for (int kh = 0; kh < K; ++kh) {
+#pragma GCC unroll 8
+            for (int kw = 0; kw < K; ++kw) {
+                acc += rows[kh][base + kw] * w[kh][kw];
+            }
+        }
+        out[ow] += acc;
+    }
+    for (int ow = max(ow_end, ow_begin); ow < out_width; ++ow) border(ow);
+}
+
+// DEFINE fixed-shape conv function, K / S / P are compile-time constants
+template <int K, int S, int P>
+vector<vector<vector<vector<double>>>> conv2d_fixed(
+    const vector<vector<vector<vector<double>>>>& input,
+    const vector<vector<vector<vector<double>>>>& kernel) {
+
+    int batch = input.size();
+    int in_channels = input[0].size();
+    int height = input[0][0].size();
+    int width = input[0][0][0].size();
+    int out_channels = kernel.size();
+    int out_height = (height - K + 2 * P) / S + 1;
+    int out_width = (width - K + 2 * P) / S + 1;
+
+    // INTERIOR columns: ow * S - P >= 0 and ow * S - P + K - 1 < width
+    int ow_begin = min(out_width, (P + S - 1) / S);
+    int ow_end = max(0, min(out_width, (width - K + P) / S + 1));
+
+    vector<vector<vector<vector<double>>>> output(batch, vector<vector<vector<double>>>(out_channels, vector<vector<double>>(out_height, vector<double>(out_width, 0))));
+
+    for (int b = 0; b < batch; ++b) {
+        for (int oc = 0; oc < out_channels; ++oc) {
+            for (int ic = 0; ic < in_channels; ++ic) {
+                double w[K][K];
+                for (int kh = 0; kh < K; ++kh)
+                    for (int kw = 0; kw < K; ++kw)
+                        w[kh][kw] = kernel[oc][ic][kh][kw];
+
+                for (int oh = 0; oh < out_height; ++oh) {
+                    const double* rows[K];
+                    bool full = true;
+                    for (int kh = 0; kh < K; ++kh) {
+                        int h_offset = oh * S + kh - P;
+                        bool inside = h_offset >= 0 && h_offset < height;
+                        rows[kh] = inside ? input[b][ic][h_offset].data() : nullptr;
+                        full = full && inside;
+                    }
+                    double* out = output[b][oc][oh].data();
+                    if (full) conv_row_fixed<K, S, P>(rows, w, out, width, out_width, ow_begin, ow_end);
+                    else conv_row_fixed<K, S, P>(rows, w, out, width, out_width, 0, 0); // padded rows: all border
+                }
+            }
+        }
+    }
+
+    return output;
+}
+
+// DISPATCH to a specialization when (K, STRIDE, PADDING) matches one, else the generic path
+vector<vector<vector<vector<double>>>> conv2d_dispatch(
+    const vector<vector<vector<vector<double>>>>& input,
+    const vector<vector<vector<vector<double>>>>& kernel,
+    int STRIDE, int PADDING, bool* specialized = nullptr) {
+
+    int K = kernel[0][0].size();
+    if (specialized) *specialized = true;
+#define CONV_FIXED_CASE(k, s, p) \
+    if (K == k && STRIDE == s && PADDING == p) return conv2d_fixed<k, s, p>(input, kernel);
+    CONV_FIXED_CASE(1, 1, 0) CONV_FIXED_CASE(1, 2, 0)
+    CONV_FIXED_CASE(3, 1, 0) CONV_FIXED_CASE(3, 2, 0) CONV_FIXED_CASE(3, 1, 1) CONV_FIXED_CASE(3, 2, 1)
+    CONV_FIXED_CASE(5, 1, 0) CONV_FIXED_CASE(5, 2, 0) CONV_FIXED_CASE(5, 1, 2) CONV_FIXED_CASE(5, 2, 2)
+#undef CONV_FIXED_CASE
+    if (specialized) *specialized = false;
+    return conv2d(input, kernel, STRIDE, PADDING);
+}
+
+void test(const vector<vector<vector<vector<double>>>>& output, const vector<vector<vector<vector<double>>>>& truth) {
+    assert(output.size() == truth.size() && output[0].size() == truth[0].size());
+    for (size_t oc = 0; oc < truth[0].size(); ++oc) {
+        assert(output[0][oc].size() == truth[0][oc].size());
+        for (size_t oh = 0; oh < truth[0][oc].size(); ++oh) {
+            assert(output[0][oc][oh].size() == truth[0][oc][oh].size());
+            for (size_t ow = 0; ow < truth[0][oc][oh].size(); ++ow) {
+                assert(fabs(output[0][oc][oh][ow] - truth[0][oc][oh][ow]) < 1e-9);
+            }
+        }
+    }
+}
+
+int main() {
+    string filename = "pointcloud.csv";
+    init(filename, HEIGHT, WIDTH);
+
+    // SHAPES are {KERNEL_SIZE, STRIDE, PADDING}, the last one has no specialization
+    const int shapes[][3] = { {1, 1, 0}, {1, 2, 0}, {3, 1, 0}, {3, 2, 0}, {3, 1, 1}, {3, 2, 1},
+                              {5, 1, 0}, {5, 2, 0}, {5, 1, 2}, {5, 2, 2}, {7, 1, 3} };
+
+    cout << endl;
+    cout << "===== SPECIALIZED CONV OUT_CHANNELS = " << OUT_CHANNELS << " =====" << endl;
+    for (const auto& shape : shapes) {
+        int K = shape[0], S = shape[1], P = shape[2];
+        // Non-uniform weights so a wrong tap order is caught by test()
+        vector<vector<vector<vector<double>>>> kernel(OUT_CHANNELS, vector<vector<vector<double>>>(IN_CHANNELS, vector<vector<double>>(K, vector<double>(K))));
+        for (size_t oc = 0; oc < OUT_CHANNELS; ++oc)
+            for (int kh = 0; kh < K; ++kh)
+                for (int kw = 0; kw < K; ++kw)
+                    kernel[oc][0][kh][kw] = 0.5 + 0.125 * ((oc + kh * K + kw) % 5);
+
+        double generic_time = 0.0, fixed_time = 0.0;
+        bool specialized = false;
+        vector<vector<vector<vector<double>>>> truth;
+        for (int iter = 0; iter < iterations; iter++) {
+            auto t = get_time();
+            truth = conv2d(input, kernel, S, P);
+            generic_time += get_time() - t;
+        }
+        for (int iter = 0; iter < iterations; iter++) {
+            auto t = get_time();
+            vector<vector<vector<vector<double>>>> output = conv2d_dispatch(input, kernel, S, P, &specialized);
+            fixed_time += get_time() - t;
+            if (iter == 0) test(output, truth);
+        }
+        cout << "K=" << K << " S=" << S << " P=" << P << (specialized ? "\t[fixed]  " : "\t[generic]")
+             << "\tgeneric: " << generic_time / iterations << "s\tdispatch: " << fixed_time / iterations
+             << "s\tspeedup: " << generic_time / fixed_time << "x" << endl;
+    }
+    cout << endl;
+
+    return 0;
+}
@@ -0,0 +1,274 @@
+#include <sys/time.h>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+/*
+ Multi-layer conv executor with static memory planning. A network is a list of
+ conv layers whose activations are tensors in [C, H, W] layout. prepare() infers
+ every shape, runs liveness analysis over the layer order and assigns each tensor
+ an offset in one arena so tensors with disjoint lifetimes share memory. run()
+ then executes the whole network without allocating.
+*/
+
+double get_time() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+// INITIALIZE paras
+size_t HEIGHT = 64;
+size_t WIDTH = 4096;
+int iterations = 8;
+
+// A conv layer reads tensor `input` (and adds tensor `residual` when >= 0), writes one new tensor.
+// Tensor 0 is the network input, layer i produces tensor i + 1.
+struct ConvLayer {
+    string name;
+    int out_channels;
+    int kernel_size;
+    int stride;
+    int padding;
+    bool relu;
+    int input;
+    int residual;
+};
+
+struct TensorInfo {
+    int channels = 0, height = 0, width = 0;
+    int first_use = 0, last_use = 0; // layer steps during which the tensor must stay live
+    size_t offset = 0;               // in elements, inside the arena
+    size_t size() const { return size_t(channels) * height * width; }
+};
+
+struct Network {
+    vector<ConvLayer> layers;
+    vector<vector<double>> weights; // [OC][IC][K][K] flattened per layer
+    vector<TensorInfo> tensors;
+    vector<double> arena;
+    size_t sum_of_tensors = 0, max_live = 0;
+
+    void prepare(int in_channels, int height, int width);
+    const double* run(const vector<double>& input);
+    const TensorInfo& output() const { return tensors.back(); }
+};
+
+// SHAPE inference, liveness analysis and offset assignment
+void Network::prepare(int in_channels, int height, int width) {
+    int n = layers.size();
+    tensors.assign(n + 1, TensorInfo());
+    tensors[0].channels = in_channels;
+    tensors[0].height = height;
+    tensors[0].width = width;
+    tensors[0].first_use = tensors[0].last_use = 0;
+
+    weights.resize(n);
+    for (int i = 0; i < n; i++) {
+        const ConvLayer& l = layers[i];
+        const TensorInfo& in = tensors[l.input];
+        TensorInfo& out = tensors[i + 1];
+        assert(l.input <= i);
+        out.channels = l.out_channels;
+        out.height = (in.height - l.kernel_size + 2 * l.padding) / l.stride + 1;
+        out.width = (in.width - l.kernel_size + 2 * l.padding) / l.stride + 1;
+        out.first_use = out.last_use = i;
+        if (l.residual >= 0) {
+            const TensorInfo& res = tensors[l.residual];
+            assert(res.channels == out.channels && res.height == out.height && res.width == out.width);
+        }
+
+        // EXTEND lifetimes of the tensors this layer reads
+        tensors[l.input].last_use = max(tensors[l.input].last_use, i);
+        if (l.residual >= 0) tensors[l.residual].last_use = max(tensors[l.residual].last_use, i);
+
+        if (weights[i].empty()) {
+            size_t count = size_t(l.out_channels) * in.channels * l.kernel_size * l.kernel_size;
+            weights[i].resize(count);
+            for (size_t k = 0; k < count; k++) weights[i][k] = 0.5 / (in.channels * l.kernel_size) * (1 + k % 3);
+        }
+    }
+    tensors[n].last_use = n; // the network output outlives every layer
+
+    // PLACE tensors largest first at the lowest offset that does not overlap a live neighbour
+    vector<int> order(n + 1);
+    for (int t = 0; t <= n; t++) order[t] = t;
+    sort(order.begin(), order.end(), [&](int a, int b) { return tensors[a].size() > tensors[b].size(); });
+
+    vector<int> placed;
+    size_t arena_size = 0;
+    for (int t : order) {
+        TensorInfo& cur = tensors[t];
+        vector<pair<size_t, size_t>> busy; // [begin, end) of conflicting tensors
+        for (int p : placed) {
+            const TensorInfo& o = tensors[p];
+            if (o.first_use <= cur.last_use && cur.first_use <= o.last_use) busy.push_back({ o.offset, o.offset + o.size() });
+        }
+        sort(busy.begin(), busy.end());
+        size_t offset = 0;
+        for (const auto& range : busy) {
+            if (offset + cur.size() <= range.first) break;
+            offset = max(offset, range.second);
+        }
+        cur.offset = offset;
+        arena_size = max(arena_size, offset + cur.size());
+        placed.push_back(t);
+    }
+    arena.assign(arena_size, 0.0);
+
+    // REPORT the naive footprint and the lower bound (largest live set over all steps)
+    sum_of_tensors = 0;
+    max_live = 0;
+    for (const TensorInfo& t : tensors) sum_of_tensors += t.size();
+    for (int step = 0; step <= n; step++) {
+        size_t live = 0;
+        for (const TensorInfo& t : tensors)
+            if (t.first_use <= step && step <= t.last_use) live += t.size();
+        max_live = max(max_live, live);
+    }
+}
+
+// DIRECT conv on flat [C, H, W] buffers, optional residual add and ReLU in the write-back
+void conv_layer(const double* in, const TensorInfo& in_info, const double* w, const ConvLayer& l,
+                const double* residual, double* out, const TensorInfo& out_info) {
+    int K = l.kernel_size;
+    for (int oc = 0; oc < out_info.channels; ++oc) {
+        for (int oh = 0; oh < out_info.height; ++oh) {
+            double* out_row = out + (size_t(oc) * out_info.height + oh) * out_info.width;
+            for (int ow = 0; ow < out_info.width; ++ow) out_row[ow] = 0.0;
+            for (int ic = 0; ic < in_info.channels; ++ic) {
+                for (int kh = 0; kh < K; ++kh) {
+                    int h_offset = oh * l.stride + kh - l.padding;
+                    if (h_offset < 0 || h_offset >= in_info.height) continue;
+                    const double* in_row = in + (size_t(ic) * in_info.height + h_offset) * in_info.width;
+                    for (int kw = 0; kw < K; ++kw) {
+                        double k = w[((size_t(oc) * in_info.channels + ic) * K + kh) * K + kw];
+                        for (int ow = 0; ow < out_info.width; ++ow) {
+                            int w_offset = ow * l.stride + kw - l.padding;
+                            if (w_offset >= 0 && w_offset < in_info.width) out_row[ow] += in_row[w_offset] * k;
+                        }
+                    }
+                }
+            }
+            if (residual) {
+                const double* res_row = residual + (size_t(oc) * out_info.height + oh) * out_info.width;
+                for (int ow = 0; ow < out_info.width; ++ow) out_row[ow] += res_row[ow];
+            }
+            if (l.relu) {
+                for (int ow = 0; ow < out_info.width; ++ow) out_row[ow] = max(out_row[ow], 0.0);
+            }
+        }
+    }
+}
+
+// EXECUTE all layers inside the planned arena
+const double* Network::run(const vector<double>& input) {
+    copy(input.begin(), input.end(), arena.begin() + tensors[0].offset);
+    for (size_t i = 0; i < layers.size(); i++) {
+        const ConvLayer& l = layers[i];
+        const double* residual = l.residual >= 0 ? &arena[tensors[l.residual].offset] : nullptr;
+        conv_layer(&arena[tensors[l.input].offset], tensors[l.input], weights[i].data(), l, residual,
+                   &arena[tensors[i + 1].offset], tensors[i + 1]);
+    }
+    return &arena[output().offset];
+}
+
+// REFERENCE execution with one fresh buffer per tensor
+vector<double> run_unplanned(const Network& net, const vector<double>& input) {
+    vector<vector<double>> buffers(net.tensors.size());
+    buffers[0] = input;
+    for (size_t i = 0; i < net.layers.size(); i++) {
+        const ConvLayer& l = net.layers[i];
+        buffers[i + 1].assign(net.tensors[i + 1].size(), 0.0);
+        const double* residual = l.residual >= 0 ? buffers[l.residual].data() : nullptr;
+        conv_layer(buffers[l.input].data(), net.tensors[l.input], net.weights[i].data(), l, residual,
+                   buffers[i + 1].data(), net.tensors[i + 1]);
+    }
+    return buffers.back();
+}
+
+vector<double> init(const string& filename, size_t rows, size_t cols) {
+    vector<double> input(rows * cols, 0.0);
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Failed to open file: " << filename << endl;
+        return input;
+    }
+
+    string line;
+    size_t row = 0;
+
+    while (getline(file, line)) { // split the data by line
+        if (row >= rows) break;
+        stringstream ss(line);
+        string value;
+        size_t col = 0;
+
+        while (getline(ss, value, ',')) { // split each line by ","
+            if (col >= cols) break;
+            input[row * cols + col] = round(stod(value));
+            col++;
+        }
+        row++;
+    }
+
+    file.close();
+    return input;
+}
+
+int main() {
+    string filename = "pointcloud.csv";
+    vector<double> input = init(filename, HEIGHT, WIDTH);
+
+    // A small residual backbone: stem, two downsampling stages with skip connections, head
+    Network net;
+    net.layers = {
+        // name        OC  K  S  P  relu  input residual
+        { "stem",       8, 3, 1, 1, true,  0, -1 },
+        { "down1",     16, 3, 2, 1, true,  1, -1 },
+        { "res1a",     16, 3, 1, 1, true,  2, -1 },
+        { "res1b",     16, 3, 1, 1, true,  3,  2 },
+        { "down2",     32, 3, 2, 1, true,  4, -1 },
+        { "res2a",     32, 3, 1, 1, true,  5, -1 },
+        { "res2b",     32, 3, 1, 1, true,  6,  5 },
+        { "head",       4, 1, 1, 0, false, 7, -1 },
+    };
+    net.prepare(1, HEIGHT, WIDTH);
+
+    cout << endl;
+    cout << "===== STATIC MEMORY PLAN (" << net.layers.size() << " layers) =====" << endl;
+    for (size_t t = 0; t < net.tensors.size(); t++) {
+        const TensorInfo& info = net.tensors[t];
+        cout << (t == 0 ? string("input") : net.layers[t - 1].name) << "\t[" << info.channels << ", " << info.height << ", " << info.width
+             << "]\tlive: " << info.first_use << "-" << info.last_use << "\toffset: " << info.offset * sizeof(double) / 1024 << " KB" << endl;
+    }
+    cout << "Sum of all tensors: " << net.sum_of_tensors * sizeof(double) / 1024 << " KB\tMax live set: " << net.max_live * sizeof(double) / 1024
+         << " KB\tArena: " << net.arena.size() * sizeof(double) / 1024 << " KB" << endl;
+
+    // CHECK the planned execution against per-tensor buffers
+    vector<double> truth = run_unplanned(net, input);
+    const double* planned = net.run(input);
+    for (size_t i = 0; i < truth.size(); i++) assert(fabs(planned[i] - truth[i]) < 1e-9);
+
+    double planned_time = 0.0, unplanned_time = 0.0;
+    for (int iter = 0; iter < iterations; iter++) {
+        auto t = get_time();
+        net.run(input);
+        planned_time += get_time() - t;
+
+        t = get_time();
+        run_unplanned(net, input);
+        unplanned_time += get_time() - t;
+    }
+    cout << "###@@@ Avg Time for Calculation(planned arena): " << planned_time / iterations << "s, (fresh buffers): " << unplanned_time / iterations << "s." << endl;
+    cout << endl;
+
+    return 0;
+}
@@ -0,0 +1,376 @@
+#include <sys/time.h>
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+/*
+ Fused conv epilogues. Bias, ReLU / ReLU6 and 2x2 max / avg pooling are applied
+ inside the write-back of the im2col and direct conv, and batch-norm is folded
+ into the weights and bias at prepare time, so each output element is written to
+ memory exactly once. The unfused pipeline (conv, then one full pass per op) is
+ kept as the reference.
+*/
+
+// INITIALIZE paras
+size_t BATCH = 1;
+size_t HEIGHT = 64;
+size_t WIDTH = 4096;
+size_t IN_CHANNELS = 1;
+size_t OUT_CHANNELS = 64;
+size_t KERNEL_SIZE = 3;
+size_t STRIDE = 1;
+size_t PADDING = 0;
+int iterations = 8;
+
+double get_time() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+typedef vector<vector<vector<vector<double>>>> Tensor4D;
+
+Tensor4D input(BATCH, vector<vector<vector<double>>>(IN_CHANNELS, vector<vector<double>>(HEIGHT, vector<double>(WIDTH))));
+// INITIALIZE kernel by filling 0.5
+Tensor4D kernel(OUT_CHANNELS, vector<vector<vector<double>>>(IN_CHANNELS, vector<vector<double>>(KERNEL_SIZE, vector<double>(KERNEL_SIZE, 0.5))));
+
+void init(const string& filename, size_t rows, size_t cols) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Failed to open file: " << filename << endl;
+        return;
+    }
+
+    string line;
+    size_t row = 0;
+
+    while (getline(file, line)) { // split the data by line
+        if (row >= rows) break;
+        stringstream ss(line);
+        string value;
+        size_t col = 0;
+
+        while (getline(ss, value, ',')) { // split each line by ","
+            if (col >= cols) break;
+            input[0][0][row][col] = round(stod(value));
+            col++;
+        }
+        row++;
+    }
+
+    file.close();
+}
+
+enum Activation { ACT_NONE, ACT_RELU, ACT_RELU6 };
+enum Pooling { POOL_NONE, POOL_MAX2, POOL_AVG2 };
+
+struct BatchNorm {
+    vector<double> gamma, beta, mean, var;
+    double eps = 1e-5;
+};
+
+// Everything applied between the accumulator and the store
+struct Epilogue {
+    vector<double> bias; // per out channel, empty for no bias
+    Activation act = ACT_NONE;
+    Pooling pool = POOL_NONE;
+};
+
+inline double activate(double v, Activation act) {
+    if (act == ACT_RELU) return max(v, 0.0);
+    if (act == ACT_RELU6) return min(max(v, 0.0), 6.0);
+    return v;
+}
+
+// FOLD batch-norm into the conv: w' = w * s, b' = (b - mean) * s + beta with s = gamma / sqrt(var + eps)
+void fold_batch_norm(Tensor4D& kernel, Epilogue& epi, const BatchNorm& bn) {
+    size_t out_channels = kernel.size();
+    if (epi.bias.empty()) epi.bias.assign(out_channels, 0.0);
+    for (size_t oc = 0; oc < out_channels; ++oc) {
+        double s = bn.gamma[oc] / sqrt(bn.var[oc] + bn.eps);
+        for (auto& plane : kernel[oc])
+            for (auto& row : plane)
+                for (double& w : row) w *= s;
+        epi.bias[oc] = (epi.bias[oc] - bn.mean[oc]) * s + bn.beta[oc];
+    }
+}
+
+// APPLY bias and activation to `rows` conv rows of channel oc, then pool / store them into out_plane
+void write_back(vector<vector<double>>& rows, int num_rows, int out_width, int oc, int oh0,
+                const Epilogue& epi, vector<vector<double>>& out_plane) {
+    double bias = epi.bias.empty() ? 0.0 : epi.bias[oc];
+    for (int r = 0; r < num_rows; ++r) {
+        double* row = rows[r].data();
+        for (int ow = 0; ow < out_width; ++ow) row[ow] = activate(row[ow] + bias, epi.act);
+    }
+    if (epi.pool == POOL_NONE) {
+        for (int r = 0; r < num_rows; ++r) copy(rows[r].begin(), rows[r].begin() + out_width, out_plane[oh0 + r].begin());
+        return;
+    }
+    double* dst = out_plane[oh0 / 2].data();
+    const double* r0 = rows[0].data();
+    const double* r1 = rows[1].data();
+    for (int pw = 0; pw < out_width / 2; ++pw) {
+        double a = r0[2 * pw], b = r0[2 * pw + 1], c = r1[2 * pw], d = r1[2 * pw + 1];
+        dst[pw] = epi.pool == POOL_MAX2 ? max(max(a, b), max(c, d)) : 0.25 * (a + b + c + d);
+    }
+}
+
+Tensor4D allocate_output(int batch, int out_channels, int out_height, int out_width, const Epilogue& epi) {
+    if (epi.pool != POOL_NONE) {
+        out_height /= 2;
+        out_width /= 2;
+    }
+    return Tensor4D(batch, vector<vector<vector<double>>>(out_channels, vector<vector<double>>(out_height, vector<double>(out_width))));
+}
+
+// DIRECT conv with fused epilogue, conv rows are produced one pooling window (1 or 2 rows) at a time
+Tensor4D conv2d_fused(const Tensor4D& input, const Tensor4D& kernel, const Epilogue& epi, int STRIDE, int PADDING) {
+    int batch = input.size();
+    int in_channels = input[0].size();
+    int height = input[0][0].size();
+    int width = input[0][0][0].size();
+    int out_channels = kernel.size();
+    int kernel_size = kernel[0][0].size();
+    int out_height = (height - kernel_size + 2 * PADDING) / STRIDE + 1;
+    int out_width = (width - kernel_size + 2 * PADDING) / STRIDE + 1;
+    int group = epi.pool == POOL_NONE ? 1 : 2;
+    int last_row = out_height - out_height % group; // pooling drops an odd trailing row
+
+    Tensor4D output = allocate_output(batch, out_channels, out_height, out_width, epi);
+    vector<vector<double>> rows(group, vector<double>(out_width));
+
+    for (int b = 0; b < batch; ++b) {
+        for (int oc = 0; oc < out_channels; ++oc) {
+            for (int oh0 = 0; oh0 < last_row; oh0 += group) {
+                for (int r = 0; r < group; ++r) {
+                    double* acc = rows[r].data();
+                    fill(acc, acc + out_width, 0.0);
+                    for (int ic = 0; ic < in_channels; ++ic) {
+                        for (int kh = 0; kh < kernel_size; ++kh) {
+                            int h_offset = (oh0 + r) * STRIDE + kh - PADDING;
+                            if (h_offset < 0 || h_offset >= height) continue;
+                            const double* in_row = input[b][ic][h_offset].data();
+                            for (int kw = 0; kw < kernel_size; ++kw) {
+                                double k = kernel[oc][ic][kh][kw];
+                                for (int ow = 0; ow < out_width; ++ow) {
+                                    int w_offset = ow * STRIDE + kw - PADDING;
+                                    if (w_offset >= 0 && w_offset < width) acc[ow] += in_row[w_offset] * k;
+                                }
+                            }
+                        }
+                    }
+                }
+                write_back(rows, group, out_width, oc, oh0, epi, output[b][oc]);
+            }
+        }
+    }
+    return output;
+}
+
+// IM2COL conv with fused epilogue, the column matrix is built one pooling window of rows at a time
+Tensor4D conv2d_im2col_fused(const Tensor4D& input, const Tensor4D& kernel, const Epilogue& epi, int STRIDE, int PADDING) {
+    int batch = input.size();
+    int in_channels = input[0].size();
+    int height = input[0][0].size();
+    int width = input[0][0][0].size();
+    int out_channels = kernel.size();
+    int kernel_size = kernel[0][0].size();
+    int out_height = (height - kernel_size + 2 * PADDING) / STRIDE + 1;
+    int out_width = (width - kernel_size + 2 * PADDING) / STRIDE + 1;
+    int group = epi.pool == POOL_NONE ? 1 : 2;
+    int last_row = out_height - out_height % group;
+    int col_width = in_channels * kernel_size * kernel_size;
+
+    // CONVERT kernel to matrix
+    vector<double> kernel_matrix(out_channels * col_width);
+    for (int oc = 0; oc < out_channels; ++oc)
+        for (int ic = 0; ic < in_channels; ++ic)
+            for (int kh = 0; kh < kernel_size; ++kh)
+                for (int kw = 0; kw < kernel_size; ++kw)
+                    kernel_matrix[oc * col_width + (ic * kernel_size + kh) * kernel_size + kw] = kernel[oc][ic][kh][kw];
+
+    Tensor4D output = allocate_output(batch, out_channels, out_height, out_width, epi);
+    vector<double> cols(group * out_width * col_width);
+    vector<vector<vector<double>>> rows(out_channels, vector<vector<double>>(group, vector<double>(out_width)));
+
+    for (int b = 0; b < batch; ++b) {
+        for (int oh0 = 0; oh0 < last_row; oh0 += group) {
+            // CALCULATE the im2col block of these rows
+            for (int r = 0; r < group; ++r) {
+                for (int ow = 0; ow < out_width; ++ow) {
+                    double* col = &cols[(r * out_width + ow) * col_width];
+                    int row_idx = 0;
+                    for (int ic = 0; ic < in_channels; ++ic) {
+                        for (int kh = 0; kh < kernel_size; ++kh) {
+                            for (int kw = 0; kw < kernel_size; ++kw) {
+                                int h_offset = (oh0 + r) * STRIDE + kh - PADDING;
+                                int w_offset = ow * STRIDE + kw - PADDING;
+                                col[row_idx++] = (h_offset >= 0 && h_offset < height && w_offset >= 0 && w_offset < width)
+                                                     ? input[b][ic][h_offset][w_offset] : 0.0;
+                            }
+                        }
+                    }
+                }
+            }
+            // MULTIPLY the block with the kernel matrix, then write every channel back once
+            for (int oc = 0; oc < out_channels; ++oc) {
+                const double* k = &kernel_matrix[oc * col_width];
+                for (int r = 0; r < group; ++r) {
+                    double* acc = rows[oc][r].data();
+                    for (int ow = 0; ow < out_width; ++ow) {
+                        const double* col = &cols[(r * out_width + ow) * col_width];
+                        double sum = 0.0;
+                        for (int i = 0; i < col_width; ++i) sum += col[i] * k[i];
+                        acc[ow] = sum;
+                    }
+                }
+                write_back(rows[oc], group, out_width, oc, oh0, epi, output[b][oc]);
+            }
+        }
+    }
+    return output;
+}
+
+// DEFINE conv function (unfused reference)
+Tensor4D conv2d(const Tensor4D& input, const Tensor4D& kernel, int STRIDE, int PADDING) {
+    int batch = input.size();
+    int in_channels = input[0].size();
+    int height = input[0][0].size();
+    int width = input[0][0][0].size();
+    int out_channels = kernel.size();
+    int kernel_size = kernel[0][0].size();
+    int out_height = (height - kernel_size + 2 * PADDING) / STRIDE + 1;
+    int out_width = (width - kernel_size + 2 * PADDING) / STRIDE + 1;
+
+    Tensor4D output(batch, vector<vector<vector<double>>>(out_channels, vector<vector<double>>(out_height, vector<double>(out_width, 0))));
+    for (int b = 0; b < batch; ++b)
+        for (int oc = 0; oc < out_channels; ++oc)
+            for (int oh = 0; oh < out_height; ++oh)
+                for (int ow = 0; ow < out_width; ++ow)
+                    for (int ic = 0; ic < in_channels; ++ic)
+                        for (int kh = 0; kh < kernel_size; ++kh)
+                            for (int kw = 0; kw < kernel_size; ++kw) {
+                                int h_offset = oh * STRIDE + kh - PADDING;
+                                int w_offset = ow * STRIDE + kw - PADDING;
+                                if (h_offset >= 0 && h_offset < height && w_offset >= 0 && w_offset < width)
+                                    output[b][oc][oh][ow] += input[b][ic][h_offset][w_offset] * kernel[oc][ic][kh][kw];
+                            }
+    return output;
+}
+
+// SEPARATE full passes of the unfused pipeline
+Tensor4D add_bias(const Tensor4D& x, const vector<double>& bias) {
+    Tensor4D y = x;
+    for (auto& batch : y) for (size_t oc = 0; oc < batch.size(); ++oc) for (auto& row : batch[oc]) for (double& v : row) v += bias[oc];
+    return y;
+}
+
+Tensor4D batch_norm(const Tensor4D& x, const BatchNorm& bn) {
+    Tensor4D y = x;
+    for (auto& batch : y)
+        for (size_t oc = 0; oc < batch.size(); ++oc)
+            for (auto& row : batch[oc])
+                for (double& v : row) v = (v - bn.mean[oc]) / sqrt(bn.var[oc] + bn.eps) * bn.gamma[oc] + bn.beta[oc];
+    return y;
+}
+
+Tensor4D activation(const Tensor4D& x, Activation act) {
+    Tensor4D y = x;
+    for (auto& batch : y) for (auto& plane : batch) for (auto& row : plane) for (double& v : row) v = activate(v, act);
+    return y;
+}
+
+Tensor4D pool2x2(const Tensor4D& x, Pooling pool) {
+    Tensor4D y(x.size(), vector<vector<vector<double>>>(x[0].size(), vector<vector<double>>(x[0][0].size() / 2, vector<double>(x[0][0][0].size() / 2))));
+    for (size_t b = 0; b < y.size(); ++b)
+        for (size_t oc = 0; oc < y[b].size(); ++oc)
+            for (size_t ph = 0; ph < y[b][oc].size(); ++ph)
+                for (size_t pw = 0; pw < y[b][oc][ph].size(); ++pw) {
+                    double a = x[b][oc][2 * ph][2 * pw], c = x[b][oc][2 * ph][2 * pw + 1];
+                    double d = x[b][oc][2 * ph + 1][2 * pw], e = x[b][oc][2 * ph + 1][2 * pw + 1];
+                    y[b][oc][ph][pw] = pool == POOL_MAX2 ? max(max(a, c), max(d, e)) : 0.25 * (a + c + d + e);
+                }
+    return y;
+}
+
+Tensor4D conv2d_unfused(const Tensor4D& input, const Tensor4D& kernel, const vector<double>& bias, const BatchNorm& bn,
+                        Activation act, Pooling pool, int STRIDE, int PADDING) {
+    Tensor4D y = batch_norm(add_bias(conv2d(input, kernel, STRIDE, PADDING), bias), bn);
+    y = activation(y, act);
+    return pool == POOL_NONE ? y : pool2x2(y, pool);
+}
+
+void test(const Tensor4D& output, const Tensor4D& truth) {
+    assert(output[0].size() == truth[0].size() && output[0][0].size() == truth[0][0].size() && output[0][0][0].size() == truth[0][0][0].size());
+    for (size_t oc = 0; oc < truth[0].size(); ++oc)
+        for (size_t h = 0; h < truth[0][oc].size(); ++h)
+            for (size_t w = 0; w < truth[0][oc][h].size(); ++w)
+                assert(fabs(output[0][oc][h][w] - truth[0][oc][h][w]) < 1e-9);
+}
+
+int main() {
+    string filename = "pointcloud.csv";
+    init(filename, HEIGHT, WIDTH);
+
+    vector<double> bias(OUT_CHANNELS);
+    BatchNorm bn;
+    for (size_t oc = 0; oc < OUT_CHANNELS; ++oc) {
+        bias[oc] = 0.1 * (oc % 7) - 0.3;
+        bn.gamma.push_back(1.0 + 0.05 * (oc % 5));
+        bn.beta.push_back(0.2 - 0.1 * (oc % 3));
+        bn.mean.push_back(0.5 + 0.01 * oc);
+        bn.var.push_back(0.8 + 0.1 * (oc % 4));
+    }
+
+    const Activation acts[] = { ACT_RELU, ACT_RELU6 };
+    const Pooling pools[] = { POOL_NONE, POOL_MAX2, POOL_AVG2 };
+    const char* act_names[] = { "none", "relu", "relu6" };
+    const char* pool_names[] = { "none", "max2x2", "avg2x2" };
+
+    cout << endl;
+    cout << "===== FUSED EPILOGUE CONV OUT_CHANNELS = " << OUT_CHANNELS << " =====" << endl;
+    for (Activation act : acts) {
+        for (Pooling pool : pools) {
+            // PREPARE: fold batch-norm into a copy of the weights
+            Tensor4D folded = kernel;
+            Epilogue epi;
+            epi.bias = bias;
+            epi.act = act;
+            epi.pool = pool;
+            fold_batch_norm(folded, epi, bn);
+
+            double unfused_time = 0.0, direct_time = 0.0, im2col_time = 0.0;
+            for (int iter = 0; iter < iterations; iter++) {
+                auto t = get_time();
+                Tensor4D truth = conv2d_unfused(input, kernel, bias, bn, act, pool, STRIDE, PADDING);
+                unfused_time += get_time() - t;
+
+                t = get_time();
+                Tensor4D direct = conv2d_fused(input, folded, epi, STRIDE, PADDING);
+                direct_time += get_time() - t;
+
+                t = get_time();
+                Tensor4D im2col = conv2d_im2col_fused(input, folded, epi, STRIDE, PADDING);
+                im2col_time += get_time() - t;
+
+                if (iter == 0) {
+                    test(direct, truth);
+                    test(im2col, truth);
+                }
+            }
+            cout << "bias+bn+" << act_names[act] << "+pool:" << pool_names[pool]
+                 << "\tunfused: " << unfused_time / iterations << "s\tfused direct: " << direct_time / iterations
+                 << "s\tfused im2col: " << im2col_time / iterations << "s" << endl;
+        }
+    }
+    cout << endl;
+
+    return 0;
+}
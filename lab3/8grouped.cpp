@@ -0,0 +1,307 @@
+#include <sys/time.h>
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <cassert>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+/*
+ Grouped and depthwise convolution. The kernel is [OUT_CHANNELS][IN_CHANNELS / groups][K][K]
+ and output channel oc only reads the input channels of its own group. Depthwise 3x3
+ (groups == IN_CHANNELS == OUT_CHANNELS) has an AVX2 kernel, and depthwise + pointwise
+ can run fused so the depthwise activations never leave a row buffer.
+
+ The 64x4096 point cloud is the 64x64x64 voxel grid with the last two axes flattened,
+ so here it is viewed as 64 channels of 64x64 to give the depthwise layer real channels.
+*/
+
+// INITIALIZE paras
+size_t BATCH = 1;
+size_t CHANNELS = 64;
+size_t HEIGHT = 64;
+size_t WIDTH = 64;
+size_t OUT_CHANNELS = 128; // pointwise output channels
+size_t KERNEL_SIZE = 3;
+size_t STRIDE = 1;
+size_t PADDING = 1;
+int iterations = 32;
+
+double get_time() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+typedef vector<vector<vector<vector<double>>>> Tensor4D;
+
+Tensor4D input(BATCH, vector<vector<vector<double>>>(CHANNELS, vector<vector<double>>(HEIGHT, vector<double>(WIDTH))));
+
+// READ pointcloud.csv, row x holds the 64x64 (y, z) slice of voxel channel x
+void init(const string& filename) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Failed to open file: " << filename << endl;
+        return;
+    }
+
+    string line;
+    size_t row = 0;
+
+    while (getline(file, line)) { // split the data by line
+        if (row >= CHANNELS) break;
+        stringstream ss(line);
+        string value;
+        size_t col = 0;
+
+        while (getline(ss, value, ',')) { // split each line by ","
+            if (col >= HEIGHT * WIDTH) break;
+            input[0][row][col / WIDTH][col % WIDTH] = round(stod(value));
+            col++;
+        }
+        row++;
+    }
+
+    file.close();
+}
+
+// DEFINE grouped conv function, groups == 1 is the dense conv of 2conv.cpp
+Tensor4D conv2d_grouped(const Tensor4D& input, const Tensor4D& kernel, int groups, int STRIDE, int PADDING) {
+    int batch = input.size();
+    int in_channels = input[0].size();
+    int height = input[0][0].size();
+    int width = input[0][0][0].size();
+    int out_channels = kernel.size();
+    int group_in = kernel[0].size();
+    int kernel_size = kernel[0][0].size();
+    int out_height = (height - kernel_size + 2 * PADDING) / STRIDE + 1;
+    int out_width = (width - kernel_size + 2 * PADDING) / STRIDE + 1;
+    int group_out = out_channels / groups;
+    assert(in_channels == group_in * groups && out_channels % groups == 0);
+
+    Tensor4D output(batch, vector<vector<vector<double>>>(out_channels, vector<vector<double>>(out_height, vector<double>(out_width, 0))));
+
+    for (int b = 0; b < batch; ++b) {
+        for (int oc = 0; oc < out_channels; ++oc) {
+            int ic0 = (oc / group_out) * group_in; // first input channel of this group
+            for (int oh = 0; oh < out_height; ++oh) {
+                double* out_row = output[b][oc][oh].data();
+                for (int g = 0; g < group_in; ++g) {
+                    for (int kh = 0; kh < kernel_size; ++kh) {
+                        int h_offset = oh * STRIDE + kh - PADDING;
+                        if (h_offset < 0 || h_offset >= height) continue;
+                        const double* in_row = input[b][ic0 + g][h_offset].data();
+                        for (int kw = 0; kw < kernel_size; ++kw) {
+                            double k = kernel[oc][g][kh][kw];
+                            for (int ow = 0; ow < out_width; ++ow) {
+                                int w_offset = ow * STRIDE + kw - PADDING;
+                                if (w_offset >= 0 && w_offset < width) out_row[ow] += in_row[w_offset] * k;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return output;
+}
+
+// ONE depthwise 3x3 stride-1 output row. rows[kh] is nullptr for padded rows.
+// Columns 1 .. width-2 have the full window; the two edge columns are done separately.
+inline void depthwise3x3_row(const double* rows[3], const double w[3][3], double* out, int width) {
+    auto edge = [&](int ow) {
+        double acc = 0.0;
+        for (int kh = 0; kh < 3; ++kh) {
+            if (!rows[kh]) continue;
+            for (int kw = 0; kw < 3; ++kw) {
+                int w_offset = ow + kw - 1;
+                if (w_offset >= 0 && w_offset < width) acc += rows[kh][w_offset] * w[kh][kw];
+            }
+        }
+        out[ow] = acc;
+    };
+    int ow = 1;
+#if defined(__AVX2__) && defined(__FMA__)
+    static const double zeros[8] = {0};
+    __m256d k[3][3];
+    for (int kh = 0; kh < 3; ++kh)
+        for (int kw = 0; kw < 3; ++kw)
+            k[kh][kw] = _mm256_set1_pd(rows[kh] ? w[kh][kw] : 0.0);
+    for (; ow + 4 <= width - 1; ow += 4) {
+        __m256d acc = _mm256_setzero_pd();
+        for (int kh = 0; kh < 3; ++kh) {
+            const double* r = rows[kh] ? rows[kh] + ow - 1 : zeros;
+            acc = _mm256_fmadd_pd(_mm256_loadu_pd(r), k[kh][0], acc);
+            acc = _mm256_fmadd_pd(_mm256_loadu_pd(r + 1), k[kh][1], acc);
+            acc = _mm256_fmadd_pd(_mm256_loadu_pd(r + 2), k[kh][2], acc);
+        }
+        _mm256_storeu_pd(out + ow, acc);
+    }
+#endif
+    for (; ow < width - 1; ++ow) {
+        double acc = 0.0;
+        for (int kh = 0; kh < 3; ++kh) {
+            if (!rows[kh]) continue;
+            acc += rows[kh][ow - 1] * w[kh][0] + rows[kh][ow] * w[kh][1] + rows[kh][ow + 1] * w[kh][2];
+        }
+        out[ow] = acc;
+    }
+    edge(0);
+    if (width > 1) edge(width - 1);
+}
+
+// DEPTHWISE 3x3, stride 1, padding 1: kernel is [C][1][3][3]
+Tensor4D depthwise_conv3x3(const Tensor4D& input, const Tensor4D& kernel) {
+    int batch = input.size();
+    int channels = input[0].size();
+    int height = input[0][0].size();
+    int width = input[0][0][0].size();
+    Tensor4D output(batch, vector<vector<vector<double>>>(channels, vector<vector<double>>(height, vector<double>(width))));
+
+    for (int b = 0; b < batch; ++b) {
+        for (int c = 0; c < channels; ++c) {
+            double w[3][3];
+            for (int kh = 0; kh < 3; ++kh)
+                for (int kw = 0; kw < 3; ++kw) w[kh][kw] = kernel[c][0][kh][kw];
+            for (int oh = 0; oh < height; ++oh) {
+                const double* rows[3];
+                for (int kh = 0; kh < 3; ++kh) {
+                    int h_offset = oh + kh - 1;
+                    rows[kh] = (h_offset >= 0 && h_offset < height) ? input[b][c][h_offset].data() : nullptr;
+                }
+                depthwise3x3_row(rows, w, output[b][c][oh].data(), width);
+            }
+        }
+    }
+    return output;
+}
+
+// FUSED depthwise 3x3 + pointwise 1x1: per output row, all C depthwise rows live in a C x W buffer
+// that the pointwise GEMM consumes straight away. pointwise is [OC][C][1][1].
+Tensor4D depthwise_pointwise_fused(const Tensor4D& input, const Tensor4D& depthwise, const Tensor4D& pointwise) {
+    int batch = input.size();
+    int channels = input[0].size();
+    int height = input[0][0].size();
+    int width = input[0][0][0].size();
+    int out_channels = pointwise.size();
+    Tensor4D output(batch, vector<vector<vector<double>>>(out_channels, vector<vector<double>>(height, vector<double>(width))));
+
+    vector<double> dw_weights(channels * 9), pw_weights(out_channels * channels);
+    for (int c = 0; c < channels; ++c)
+        for (int t = 0; t < 9; ++t) dw_weights[c * 9 + t] = depthwise[c][0][t / 3][t % 3];
+    for (int oc = 0; oc < out_channels; ++oc)
+        for (int c = 0; c < channels; ++c) pw_weights[oc * channels + c] = pointwise[oc][c][0][0];
+
+    vector<double> dw_rows(channels * width);
+    for (int b = 0; b < batch; ++b) {
+        for (int oh = 0; oh < height; ++oh) {
+            for (int c = 0; c < channels; ++c) {
+                const double* rows[3];
+                for (int kh = 0; kh < 3; ++kh) {
+                    int h_offset = oh + kh - 1;
+                    rows[kh] = (h_offset >= 0 && h_offset < height) ? input[b][c][h_offset].data() : nullptr;
+                }
+                depthwise3x3_row(rows, reinterpret_cast<const double(*)[3]>(&dw_weights[c * 9]), &dw_rows[c * width], width);
+            }
+            for (int oc = 0; oc < out_channels; ++oc) {
+                double* out_row = output[b][oc][oh].data();
+                const double* pw = &pw_weights[oc * channels];
+                for (int ow = 0; ow < width; ++ow) out_row[ow] = 0.0;
+                for (int c = 0; c < channels; ++c) {
+                    const double* dw_row = &dw_rows[c * width];
+                    double k = pw[c];
+                    for (int ow = 0; ow < width; ++ow) out_row[ow] += dw_row[ow] * k;
+                }
+            }
+        }
+    }
+    return output;
+}
+
+// EXPAND a grouped kernel into the dense [OC][IC][K][K] kernel that im2col would need
+Tensor4D expand_to_dense(const Tensor4D& kernel, int groups) {
+    int out_channels = kernel.size();
+    int group_in = kernel[0].size();
+    int kernel_size = kernel[0][0].size();
+    int group_out = out_channels / groups;
+    Tensor4D dense(out_channels, vector<vector<vector<double>>>(group_in * groups, vector<vector<double>>(kernel_size, vector<double>(kernel_size, 0.0))));
+    for (int oc = 0; oc < out_channels; ++oc)
+        for (int g = 0; g < group_in; ++g)
+            dense[oc][(oc / group_out) * group_in + g] = kernel[oc][g];
+    return dense;
+}
+
+void test(const Tensor4D& output, const Tensor4D& truth) {
+    assert(output[0].size() == truth[0].size());
+    for (size_t c = 0; c < truth[0].size(); ++c)
+        for (size_t h = 0; h < truth[0][c].size(); ++h)
+            for (size_t w = 0; w < truth[0][c][h].size(); ++w)
+                assert(fabs(output[0][c][h][w] - truth[0][c][h][w]) < 1e-9);
+}
+
+Tensor4D make_kernel(int out_channels, int group_in, int kernel_size) {
+    Tensor4D kernel(out_channels, vector<vector<vector<double>>>(group_in, vector<vector<double>>(kernel_size, vector<double>(kernel_size))));
+    for (int oc = 0; oc < out_channels; ++oc)
+        for (int g = 0; g < group_in; ++g)
+            for (int kh = 0; kh < kernel_size; ++kh)
+                for (int kw = 0; kw < kernel_size; ++kw)
+                    kernel[oc][g][kh][kw] = 0.5 + 0.125 * ((oc + g + kh * kernel_size + kw) % 4);
+    return kernel;
+}
+
+template <typename F>
+double time_avg(F&& f) {
+    double total = 0.0;
+    for (int iter = 0; iter < iterations; iter++) {
+        auto t = get_time();
+        f();
+        total += get_time() - t;
+    }
+    return total / iterations;
+}
+
+int main() {
+    init("pointcloud.csv");
+    int C = CHANNELS;
+
+    cout << endl;
+    cout << "===== GROUPED CONV C = " << C << ", " << HEIGHT << "x" << WIDTH << ", K = " << KERNEL_SIZE << " =====" << endl;
+    // GROUPED: native grouped loop versus the same weights expanded to a dense conv
+    for (int groups : { 1, 4, 16, C }) {
+        Tensor4D kernel = make_kernel(C, C / groups, KERNEL_SIZE);
+        Tensor4D dense = expand_to_dense(kernel, groups);
+        Tensor4D truth = conv2d_grouped(input, dense, 1, STRIDE, PADDING);
+        test(conv2d_grouped(input, kernel, groups, STRIDE, PADDING), truth);
+        double grouped_time = time_avg([&] { conv2d_grouped(input, kernel, groups, STRIDE, PADDING); });
+        double dense_time = time_avg([&] { conv2d_grouped(input, dense, 1, STRIDE, PADDING); });
+        cout << "groups=" << groups << "\tgrouped: " << grouped_time << "s\tas dense: " << dense_time << "s" << endl;
+    }
+
+    // DEPTHWISE 3x3 kernel and depthwise + pointwise fusion
+    Tensor4D depthwise = make_kernel(C, 1, 3);
+    Tensor4D pointwise = make_kernel(OUT_CHANNELS, C, 1);
+    Tensor4D dw_truth = conv2d_grouped(input, depthwise, C, 1, 1);
+    test(depthwise_conv3x3(input, depthwise), dw_truth);
+    Tensor4D dwpw_truth = conv2d_grouped(dw_truth, pointwise, 1, 1, 0);
+    test(depthwise_pointwise_fused(input, depthwise, pointwise), dwpw_truth);
+
+    double dw_generic = time_avg([&] { conv2d_grouped(input, depthwise, C, 1, 1); });
+    double dw_simd = time_avg([&] { depthwise_conv3x3(input, depthwise); });
+    double separate = time_avg([&] { conv2d_grouped(depthwise_conv3x3(input, depthwise), pointwise, 1, 1, 0); });
+    double fused = time_avg([&] { depthwise_pointwise_fused(input, depthwise, pointwise); });
+#if defined(__AVX2__) && defined(__FMA__)
+    const char* isa = "avx2+fma";
+#else
+    const char* isa = "scalar";
+#endif
+    cout << "depthwise3x3\tgeneric: " << dw_generic << "s\tspecialized(" << isa << "): " << dw_simd << "s" << endl;
+    cout << "dw+pw (OC=" << OUT_CHANNELS << ")\tseparate: " << separate << "s\tfused: " << fused << "s" << endl;
+    cout << endl;
+
+    return 0;
+}
@@ -0,0 +1,302 @@
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <functional>
+#include <cstdlib>
+#include <cassert>
+
+using namespace std;
+
+/*
+ Tiled im2col convolution with a bounded memory footprint. Instead of materializing
+ the full column matrix, the [OH*OW x OC] result and the [OC][OH][OW] output, the
+ output is produced in (output rows x output columns x out channels) tiles. Each
+ pixel tile builds the column block of its input rows plus the K-1 halo rows, every
+ channel tile of it is multiplied and handed to a consumer callback, and the buffers
+ are reused. Tiles cover whole output rows while one row's column block fits, and
+ split rows along the width when it does not.
+
+ Usage: ./9tiled [budget_MB] [output_file]. With an output file the tiles are
+ streamed into it as a raw fp64 [OC][OH][OW] array.
+*/
+
+// INITIALIZE paras
+size_t BATCH = 1; // firmed at 1
+size_t HEIGHT = 64;
+size_t WIDTH = 4096;
+size_t IN_CHANNELS = 1;
+size_t OUT_CHANNELS = 1024;
+size_t KERNEL_SIZE = 3;
+size_t STRIDE = 1;
+size_t PADDING = 0;
+int iterations = 4;
+
+double get_time() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+// PEAK resident set size of the process so far, in MB
+double peak_rss_mb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;
+}
+
+vector<vector<vector<vector<double>>>> input(BATCH, vector<vector<vector<double>>>(IN_CHANNELS, vector<vector<double>>(HEIGHT, vector<double>(WIDTH))));
+
+void init(const string& filename, size_t rows, size_t cols) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Failed to open file: " << filename << endl;
+        return;
+    }
+
+    string line;
+    size_t row = 0;
+
+    while (getline(file, line)) { // split the data by line
+        if (row >= rows) break;
+        stringstream ss(line);
+        string value;
+        size_t col = 0;
+
+        while (getline(ss, value, ',')) { // split each line by ","
+            if (col >= cols) break;
+            input[0][0][row][col] = round(stod(value));
+            col++;
+        }
+        row++;
+    }
+
+    file.close();
+}
+
+// A finished block of the output: channels [oc0, oc1) x rows [oh0, oh1) x columns [ow0, ow1),
+// stored as data[((oc - oc0) * (oh1 - oh0) + (oh - oh0)) * (ow1 - ow0) + ow - ow0]
+struct Tile {
+    int oc0, oc1, oh0, oh1, ow0, ow1;
+    const double* data;
+    int width() const { return ow1 - ow0; }
+};
+
+typedef function<void(const Tile&)> TileConsumer;
+
+struct TilePlan {
+    int rows_per_tile;
+    int cols_per_tile;
+    int channels_per_tile;
+    size_t bytes; // column block + tile buffer
+    bool fits;    // false when even one pixel x one channel exceeds the budget
+};
+
+// PICK tile sizes so the column block takes at most a quarter of the budget and the tile half,
+// whole output rows while one row's column block fits, else a slice of one row
+TilePlan plan_tiles(size_t budget_bytes, int out_height, int out_width, int out_channels, int col_width) {
+    TilePlan plan;
+    size_t col_pixel_bytes = size_t(col_width) * sizeof(double);
+    size_t col_row_bytes = size_t(out_width) * col_pixel_bytes;
+    if (col_row_bytes <= budget_bytes / 4) {
+        plan.rows_per_tile = min(size_t(out_height), budget_bytes / 4 / col_row_bytes);
+        plan.cols_per_tile = out_width;
+    } else {
+        plan.rows_per_tile = 1;
+        plan.cols_per_tile = max(size_t(1), min(size_t(out_width), budget_bytes / 4 / col_pixel_bytes));
+    }
+    size_t pixels = size_t(plan.rows_per_tile) * plan.cols_per_tile;
+    plan.channels_per_tile = max(size_t(1), min(size_t(out_channels), budget_bytes / 2 / (pixels * sizeof(double))));
+    plan.bytes = pixels * col_pixel_bytes + size_t(plan.channels_per_tile) * pixels * sizeof(double);
+    plan.fits = plan.bytes <= budget_bytes;
+    return plan;
+}
+
+// EXECUTE Conv2D using im2col, tile by tile
+void conv2d_im2col_tiled(
+    const vector<vector<vector<vector<double>>>>& input,
+    const vector<vector<vector<vector<double>>>>& kernel,
+    int STRIDE, int PADDING, const TilePlan& plan, const TileConsumer& consume) {
+
+    int in_channels = input[0].size();
+    int height = input[0][0].size();
+    int width = input[0][0][0].size();
+    int out_channels = kernel.size();
+    int kernel_size = kernel[0][0].size();
+    int out_height = (height - kernel_size + 2 * PADDING) / STRIDE + 1;
+    int out_width = (width - kernel_size + 2 * PADDING) / STRIDE + 1;
+    int col_width = in_channels * kernel_size * kernel_size;
+
+    // CONVERT kernel to matrix
+    vector<double> kernel_matrix(out_channels * col_width);
+    for (int oc = 0; oc < out_channels; ++oc)
+        for (int ic = 0; ic < in_channels; ++ic)
+            for (int kh = 0; kh < kernel_size; ++kh)
+                for (int kw = 0; kw < kernel_size; ++kw)
+                    kernel_matrix[oc * col_width + (ic * kernel_size + kh) * kernel_size + kw] = kernel[oc][ic][kh][kw];
+
+    vector<double> cols(size_t(plan.rows_per_tile) * plan.cols_per_tile * col_width);
+    vector<double> tile(size_t(plan.channels_per_tile) * plan.rows_per_tile * plan.cols_per_tile);
+
+    for (int oh0 = 0; oh0 < out_height; oh0 += plan.rows_per_tile) {
+        for (int ow0 = 0; ow0 < out_width; ow0 += plan.cols_per_tile) {
+            int oh1 = min(out_height, oh0 + plan.rows_per_tile), ow1 = min(out_width, ow0 + plan.cols_per_tile);
+            int tile_width = ow1 - ow0, pixels = (oh1 - oh0) * tile_width;
+
+            // CALCULATE the column block, it reads input rows oh0 * STRIDE - PADDING .. (oh1 - 1) * STRIDE - PADDING + K - 1
+            for (int p = 0; p < pixels; ++p) {
+                int h = oh0 + p / tile_width, w = ow0 + p % tile_width;
+                double* col = &cols[size_t(p) * col_width];
+                int row_idx = 0;
+                for (int ic = 0; ic < in_channels; ++ic) {
+                    for (int kh = 0; kh < kernel_size; ++kh) {
+                        for (int kw = 0; kw < kernel_size; ++kw) {
+                            int h_offset = h * STRIDE + kh - PADDING;
+                            int w_offset = w * STRIDE + kw - PADDING;
+                            col[row_idx++] = (h_offset >= 0 && h_offset < height && w_offset >= 0 && w_offset < width)
+                                                 ? input[0][ic][h_offset][w_offset] : 0.0;
+                        }
+                    }
+                }
+            }
+
+            for (int oc0 = 0; oc0 < out_channels; oc0 += plan.channels_per_tile) {
+                int oc1 = min(out_channels, oc0 + plan.channels_per_tile);
+                for (int oc = oc0; oc < oc1; ++oc) {
+                    const double* k = &kernel_matrix[oc * col_width];
+                    double* dst = &tile[size_t(oc - oc0) * pixels];
+                    for (int p = 0; p < pixels; ++p) {
+                        const double* col = &cols[size_t(p) * col_width];
+                        double sum = 0.0;
+                        for (int i = 0; i < col_width; ++i) sum += col[i] * k[i];
+                        dst[p] = sum;
+                    }
+                }
+                consume(Tile{ oc0, oc1, oh0, oh1, ow0, ow1, tile.data() });
+            }
+        }
+    }
+}
+
+// REFERENCE: the untiled conv2d of 2conv.cpp
+vector<vector<vector<vector<double>>>> conv2d(
+    const vector<vector<vector<vector<double>>>>& input,
+    const vector<vector<vector<vector<double>>>>& kernel,
+    int STRIDE, int PADDING) {
+
+    int in_channels = input[0].size();
+    int height = input[0][0].size();
+    int width = input[0][0][0].size();
+    int out_channels = kernel.size();
+    int kernel_size = kernel[0][0].size();
+    int out_height = (height - kernel_size + 2 * PADDING) / STRIDE + 1;
+    int out_width = (width - kernel_size + 2 * PADDING) / STRIDE + 1;
+
+    vector<vector<vector<vector<double>>>> output(1, vector<vector<vector<double>>>(out_channels, vector<vector<double>>(out_height, vector<double>(out_width, 0))));
+    for (int oc = 0; oc < out_channels; ++oc)
+        for (int oh = 0; oh < out_height; ++oh)
+            for (int ow = 0; ow < out_width; ++ow)
+                for (int ic = 0; ic < in_channels; ++ic)
+                    for (int kh = 0; kh < kernel_size; ++kh)
+                        for (int kw = 0; kw < kernel_size; ++kw) {
+                            int h_offset = oh * STRIDE + kh - PADDING;
+                            int w_offset = ow * STRIDE + kw - PADDING;
+                            if (h_offset >= 0 && h_offset < height && w_offset >= 0 && w_offset < width)
+                                output[0][oc][oh][ow] += input[0][ic][h_offset][w_offset] * kernel[oc][ic][kh][kw];
+                        }
+    return output;
+}
+
+vector<vector<vector<vector<double>>>> make_kernel(int out_channels) {
+    vector<vector<vector<vector<double>>>> kernel(out_channels, vector<vector<vector<double>>>(IN_CHANNELS, vector<vector<double>>(KERNEL_SIZE, vector<double>(KERNEL_SIZE))));
+    for (int oc = 0; oc < out_channels; ++oc)
+        for (size_t kh = 0; kh < KERNEL_SIZE; ++kh)
+            for (size_t kw = 0; kw < KERNEL_SIZE; ++kw)
+                kernel[oc][0][kh][kw] = 0.5 + 0.125 * ((oc + kh * KERNEL_SIZE + kw) % 3);
+    return kernel;
+}
+
+int main(int argc, char** argv) {
+    size_t budget_mb = argc > 1 ? strtoul(argv[1], nullptr, 10) : 64;
+    string out_file = argc > 2 ? argv[2] : "";
+
+    string filename = "pointcloud.csv";
+    init(filename, HEIGHT, WIDTH);
+
+    int out_height = (HEIGHT - KERNEL_SIZE + 2 * PADDING) / STRIDE + 1;
+    int out_width = (WIDTH - KERNEL_SIZE + 2 * PADDING) / STRIDE + 1;
+    int col_width = IN_CHANNELS * KERNEL_SIZE * KERNEL_SIZE;
+
+    // CHECK the tiles reassemble into the untiled output, on a small channel count with tiny tiles
+    {
+        int check_channels = 12;
+        vector<vector<vector<vector<double>>>> kernel = make_kernel(check_channels);
+        vector<vector<vector<vector<double>>>> truth = conv2d(input, kernel, STRIDE, PADDING);
+        TilePlan plan = plan_tiles(256 << 10, out_height, out_width, check_channels, col_width);
+        size_t covered = 0;
+        conv2d_im2col_tiled(input, kernel, STRIDE, PADDING, plan, [&](const Tile& t) {
+            for (int oc = t.oc0; oc < t.oc1; ++oc)
+                for (int oh = t.oh0; oh < t.oh1; ++oh)
+                    for (int ow = t.ow0; ow < t.ow1; ++ow, ++covered)
+                        assert(fabs(t.data[((oc - t.oc0) * (t.oh1 - t.oh0) + oh - t.oh0) * t.width() + ow - t.ow0] - truth[0][oc][oh][ow]) < 1e-9);
+        });
+        assert(covered == size_t(check_channels) * out_height * out_width);
+        assert(plan.fits && plan.bytes <= size_t(256 << 10));
+    }
+
+    vector<vector<vector<vector<double>>>> kernel = make_kernel(OUT_CHANNELS);
+    TilePlan plan = plan_tiles(budget_mb << 20, out_height, out_width, OUT_CHANNELS, col_width);
+    if (!plan.fits) {
+        cerr << "Budget of " << budget_mb << " MB cannot hold one output pixel: " << plan.bytes << " bytes needed" << endl;
+        return 1;
+    }
+    double full_mb = (double(out_height) * out_width * (col_width + 2 * OUT_CHANNELS)) * sizeof(double) / (1 << 20);
+
+    int fd = -1;
+    if (!out_file.empty()) {
+        fd = open(out_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            cerr << "Failed to open file: " << out_file << endl;
+            return 1;
+        }
+    }
+
+    // CONSUME tiles: keep a checksum, and stream each tile row to its place in the file when asked
+    double checksum = 0.0;
+    TileConsumer consumer = [&](const Tile& t) {
+        size_t count = size_t(t.oc1 - t.oc0) * (t.oh1 - t.oh0) * t.width();
+        for (size_t i = 0; i < count; ++i) checksum += t.data[i];
+        if (fd < 0) return;
+        size_t bytes = size_t(t.width()) * sizeof(double);
+        for (int oc = t.oc0; oc < t.oc1; ++oc)
+            for (int oh = t.oh0; oh < t.oh1; ++oh) {
+                const double* src = &t.data[(size_t(oc - t.oc0) * (t.oh1 - t.oh0) + oh - t.oh0) * t.width()];
+                off_t offset = ((off_t(oc) * out_height + oh) * out_width + t.ow0) * sizeof(double);
+                if (pwrite(fd, src, bytes, offset) != ssize_t(bytes)) cerr << "Short write to " << out_file << endl;
+            }
+    };
+
+    cout << endl;
+    cout << "===== TILED im2col CONV OUT_CHANNELS = " << OUT_CHANNELS << " =====" << endl;
+    cout << "Budget: " << budget_mb << " MB\tTile: " << plan.rows_per_tile << " rows x " << plan.cols_per_tile << " cols x " << plan.channels_per_tile
+         << " channels\tBuffers: " << plan.bytes / double(1 << 20) << " MB\t(untiled col + result + output: " << full_mb << " MB)" << endl;
+    double avg_time = 0.0;
+    for (int iter = 0; iter < iterations; iter++) {
+        checksum = 0.0;
+        auto t = get_time();
+        conv2d_im2col_tiled(input, kernel, STRIDE, PADDING, plan, consumer);
+        cout << "Rnd:" << iter + 1 << "\tTime:" << get_time() - t << "s\tChecksum: " << checksum << endl;
+        avg_time += get_time() - t;
+    }
+    if (fd >= 0) close(fd);
+    cout << "###@@@ Avg Time for Calculation(tiled im2col_conv, out_channel = " << OUT_CHANNELS << "): " << avg_time / iterations
+         << "s, peak RSS: " << peak_rss_mb() << " MB." << endl;
+    cout << endl;
+
+    return 0;
+}
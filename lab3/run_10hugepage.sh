@@ -0,0 +1,2 @@
+g++ 10hugepage.cpp -o 10hugepage -std=c++17 -O3 -Wall && ./10hugepage
+rm -rf 10hugepage
@@ -0,0 +1,2 @@
+g++ 11numa.cpp -o 11numa -std=c++17 -O3 -Wall -pthread && ./11numa
+rm -rf 11numa
@@ -0,0 +1,2 @@
+g++ 12spmm.cpp -o 12spmm -std=c++17 -O3 -Wall -mavx2 -mfma && ./12spmm
+rm -rf 12spmm
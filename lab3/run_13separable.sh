@@ -0,0 +1,2 @@
+g++ 13separable.cpp -o 13separable -std=c++17 -O3 -Wall && ./13separable
+rm -rf 13separable
@@ -0,0 +1,2 @@
+g++ 14dedup.cpp -o 14dedup -std=c++17 -O3 -Wall && ./14dedup
+rm -rf 14dedup
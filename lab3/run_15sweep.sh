@@ -0,0 +1,2 @@
+g++ 15sweep.cpp -o 15sweep -std=c++17 -O3 -Wall && ./15sweep --oc=1,2,4,8,16,32,64,128,256 --format=csv
+rm -rf 15sweep
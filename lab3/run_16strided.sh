@@ -0,0 +1,2 @@
+g++ 16strided.cpp -o 16strided -std=c++17 -O3 -Wall && ./16strided
+rm -rf 16strided
@@ -0,0 +1,2 @@
+g++ 17unet.cpp -o 17unet -std=c++17 -O3 -Wall && ./17unet
+rm -rf 17unet
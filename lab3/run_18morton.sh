@@ -0,0 +1,2 @@
+g++ 18morton.cpp -o 18morton -std=c++17 -O3 -Wall && ./18morton
+rm -rf 18morton
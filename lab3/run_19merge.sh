@@ -0,0 +1,2 @@
+g++ 19merge.cpp -o 19merge -std=c++17 -O3 -Wall -mavx2 && ./19merge
+rm -rf 19merge
@@ -0,0 +1,2 @@
+g++ 20rulebook.cpp -o 20rulebook -std=c++17 -O3 -Wall && ./20rulebook
+rm -rf 20rulebook
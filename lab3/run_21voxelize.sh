@@ -0,0 +1,2 @@
+g++ 21voxelize.cpp -o 21voxelize -std=c++17 -O3 -Wall -pthread && ./21voxelize
+rm -rf 21voxelize
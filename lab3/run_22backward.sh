@@ -0,0 +1,2 @@
+g++ 22backward.cpp -o 22backward -std=c++17 -O3 -Wall -pthread && ./22backward
+rm -rf 22backward
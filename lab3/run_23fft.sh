@@ -0,0 +1,2 @@
+g++ 23fft.cpp -o 23fft -std=c++17 -O3 -Wall && ./23fft
+rm -rf 23fft
@@ -0,0 +1,2 @@
+g++ 24autotune.cpp -o 24autotune -std=c++17 -O3 -Wall && ./24autotune
+rm -rf 24autotune
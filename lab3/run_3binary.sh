@@ -0,0 +1,2 @@
+g++ 3binary.cpp -o 3binary -std=c++17 -O3 -Wall && ./3binary
+rm -rf 3binary
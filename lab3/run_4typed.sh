@@ -0,0 +1,2 @@
+g++ 4typed.cpp -o 4typed -std=c++17 -O3 -Wall && ./4typed
+rm -rf 4typed
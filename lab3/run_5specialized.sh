@@ -0,0 +1,2 @@
+g++ 5specialized.cpp -o 5specialized -std=c++17 -O3 -Wall && ./5specialized
+rm -rf 5specialized
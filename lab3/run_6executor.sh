@@ -0,0 +1,2 @@
+g++ 6executor.cpp -o 6executor -std=c++17 -O3 -Wall && ./6executor
+rm -rf 6executor
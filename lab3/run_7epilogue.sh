@@ -0,0 +1,2 @@
+g++ 7epilogue.cpp -o 7epilogue -std=c++17 -O3 -Wall && ./7epilogue
+rm -rf 7epilogue
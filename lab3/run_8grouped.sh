@@ -0,0 +1,2 @@
+g++ 8grouped.cpp -o 8grouped -std=c++17 -O3 -Wall -mavx2 -mfma && ./8grouped
+rm -rf 8grouped
@@ -0,0 +1,2 @@
+g++ 9tiled.cpp -o 9tiled -std=c++17 -O3 -Wall && ./9tiled 64
+rm -rf 9tiled